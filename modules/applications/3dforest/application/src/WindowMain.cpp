@@ -657,6 +657,7 @@ void WindowMain::actionViewLayout(WindowViewports::ViewLayout layout)
     }
 
     editor_.unlock();
+    editor_.restartThreads();
     updateViewer();
 }
 
@@ -711,7 +712,10 @@ void WindowMain::actionPluginToolShow()
 void WindowMain::actionDataSetVisible(size_t id, bool checked)
 {
     editor_.cancelThreads();
+    editor_.lock();
     editor_.setVisibleDataSet(id, checked);
+    editor_.unlock();
+    editor_.restartThreads();
     updateViewer();
     // setWindowModified(true);
 }
@@ -721,7 +725,8 @@ void WindowMain::actionClassification()
     editor_.cancelThreads();
     editor_.lock();
     editor_.setClassification(windowClassification_->classification());
-    editor_.tileViewClear();
+    editor_.tileViewClear(
+        EditorTile::filterMask(EditorTile::FILTER_CLASSIFICATION));
     editor_.unlock();
     editor_.restartThreads();
 }
@@ -731,7 +736,7 @@ void WindowMain::actionLayers()
     editor_.cancelThreads();
     editor_.lock();
     editor_.setLayers(windowLayers_->layers());
-    editor_.tileViewClear();
+    editor_.tileViewClear(EditorTile::filterMask(EditorTile::FILTER_LAYERS));
     editor_.unlock();
     editor_.restartThreads();
 }
@@ -742,7 +747,7 @@ void WindowMain::actionClipFilter(const ClipFilter &clipFilter)
     editor_.lock();
     /** @todo There is a bug when clip filter is disabled. */
     editor_.setClipFilter(clipFilter);
-    editor_.tileViewClear();
+    editor_.tileViewClear(EditorTile::filterMask(EditorTile::FILTER_CLIP));
     editor_.unlock();
     editor_.restartThreads();
 }
@@ -752,7 +757,7 @@ void WindowMain::actionClipFilterReset()
     editor_.cancelThreads();
     editor_.lock();
     editor_.resetClipFilter();
-    editor_.tileViewClear();
+    editor_.tileViewClear(EditorTile::filterMask(EditorTile::FILTER_CLIP));
     editor_.unlock();
     editor_.restartThreads();
     windowClipFilter_->setClipFilter(editor_);
@@ -772,7 +777,7 @@ void WindowMain::actionSettingsViewColor()
     editor_.cancelThreads();
     editor_.lock();
     editor_.setSettingsView(windowSettingsView_->settings());
-    editor_.tileViewClear();
+    editor_.tileViewClear(EditorTile::filterMask(EditorTile::FILTER_COLOR));
     editor_.unlock();
     editor_.restartThreads();
 }
@@ -831,10 +836,12 @@ bool WindowMain::projectOpen(const QString &path)
     catch (std::exception &e)
     {
         showError(e.what());
+        editor_.restartThreads();
         return false;
     }
 
     updateProject();
+    showDataSetMessages();
 
     return true; // Opened
 }
@@ -876,11 +883,13 @@ bool WindowMain::projectClose()
 
         if (canClose == false)
         {
+            editor_.restartThreads();
             return false;
         }
     }
 
-    // Close
+    // Close, saving restarted the threads
+    editor_.cancelThreads();
     try
     {
         editor_.close();
@@ -914,6 +923,7 @@ bool WindowMain::projectSave(const QString &path)
 
             if (fileName.isEmpty())
             {
+                editor_.restartThreads();
                 return false;
             }
             writePath = fileName.toStdString();
@@ -933,9 +943,12 @@ bool WindowMain::projectSave(const QString &path)
     catch (std::exception &e)
     {
         showError(e.what());
+        editor_.restartThreads();
         return false;
     }
 
+    editor_.restartThreads();
+
     return true; // Saved
 }
 
@@ -949,6 +962,7 @@ bool WindowMain::projectOpenFile(const QString &path)
         WindowFileImport dialog(this);
         if (dialog.exec() == QDialog::Rejected)
         {
+            editor_.restartThreads();
             return false;
         }
 
@@ -960,10 +974,12 @@ bool WindowMain::projectOpenFile(const QString &path)
     catch (std::exception &e)
     {
         showError(e.what());
+        editor_.restartThreads();
         return false;
     }
 
     updateProject();
+    showDataSetMessages();
 
     return true; // Opened
 }
@@ -1042,6 +1058,7 @@ void WindowMain::updateProject()
     windowClipFilter_->setClipFilter(editor_);
     windowSettingsView_->setSettings(editor_.settings().view());
 
+    editor_.restartThreads();
     updateViewer();
     updateWindowTitle(QString::fromStdString(editor_.path()));
 }
@@ -1068,6 +1085,24 @@ void WindowMain::showError(const char *message)
     (void)QMessageBox::critical(this, tr("Error"), message);
 }
 
+void WindowMain::showDataSetMessages()
+{
+    QString message;
+    for (size_t i = 0; i < editor_.dataSetSize(); i++)
+    {
+        const std::string &text = editor_.dataSet(i).columnsMessage;
+        if (!text.empty())
+        {
+            message += QString::fromStdString(text) + "\n";
+        }
+    }
+
+    if (!message.isEmpty())
+    {
+        (void)QMessageBox::warning(this, tr("Warning"), message);
+    }
+}
+
 void WindowMain::updateWindowTitle(const QString &path)
 {
     QString newtitle = APPLICATION_NAME;
@@ -143,6 +143,7 @@ protected:
 
     // Utilities
     void showError(const char *message);
+    void showDataSetMessages();
     void updateWindowTitle(const QString &path);
     QToolButton *createMenuButton(const QString &text,
                                   const QString &toolTip,
@@ -89,7 +89,10 @@ void PluginDatabaseStatisticsWindow::compute()
         // Process step i
         editor_->lock();
         FileIndex::Selection &selected = selection[static_cast<size_t>(i)];
-        EditorTile *tile = editor_->tile(selected.id, selected.idx);
+        EditorTile *tile =
+            editor_->tile(selected.id,
+                          selected.idx,
+                          EditorTile::columnMask(EditorTile::COLUMN_ATTRIB));
         if (tile)
         {
             computeStep(tile);
@@ -115,11 +118,13 @@ void PluginDatabaseStatisticsWindow::computeStep(EditorTile *tile)
 {
     const std::vector<EditorTile::Attributes> &attrib = tile->attrib;
 
-    for (size_t j = 0; j < tile->indices.size(); j++)
+    const std::vector<unsigned int> &indices = tile->view->indices;
+
+    for (size_t j = 0; j < indices.size(); j++)
     {
         numberOfPoints_++;
 
-        size_t row = tile->indices[j];
+        size_t row = indices[j];
         if (attrib[row].classification > 0)
         {
             classificationPoints_++;
@@ -84,7 +84,7 @@ void PluginHeightMapFilter::setPreviewEnabled(bool enabled)
     mutex_.unlock();
 
     editor_->lock();
-    editor_->tileViewClear();
+    editor_->tileViewClear(EditorTile::filterMask(EditorTile::FILTER_COLOR));
     editor_->unlock();
 
     editor_->restartThreads();
@@ -113,20 +113,20 @@ void PluginHeightMapFilter::filterTile(EditorTile *tile)
         zLenInv = 1.0 / zLen;
     }
 
-    const std::vector<unsigned int> &indices = tile->indices;
+    const std::vector<unsigned int> &indices = tile->view->indices;
+    const EditorDataSet &dataSet = editor_->dataSet(tile->dataSetId);
+    double zOrigin = dataSet.translation[2] + tile->origin[2];
 
     for (size_t i = 0; i < indices.size(); i++)
     {
         size_t row = indices[i];
 
-        double z = tile->xyz[row * 3 + 2];
+        double z = zOrigin + tile->renderPosition(row)[2];
         double zNorm = (z - zMin) * zLenInv;
 
         size_t colorIndex = static_cast<size_t>(zNorm / colorDelta);
 
-        tile->view.rgb[row * 3 + 0] *= colormap_[colorIndex][0];
-        tile->view.rgb[row * 3 + 1] *= colormap_[colorIndex][1];
-        tile->view.rgb[row * 3 + 2] *= colormap_[colorIndex][2];
+        tile->view->multiplyColor(row, colormap_[colorIndex]);
     }
 
     mutex_.unlock();
@@ -167,7 +167,9 @@ void PluginHeightMapFilter::applyToTiles(QWidget *widget)
         EditorTile *tile = editor_->tile(sel.id, sel.idx);
         if (tile)
         {
+            tile->copyOnWrite();
             filterTile(tile);
+            tile->publish();
         }
         editor_->unlock();
     }
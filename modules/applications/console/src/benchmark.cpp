@@ -0,0 +1,1901 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file benchmark.cpp */
+
+#include <EditorBase.hpp>
+#include <EditorScheduler.hpp>
+#include <EditorTaskQueue.hpp>
+#include <EditorTileFilter.hpp>
+#include <Error.hpp>
+#include <File.hpp>
+#include <FileIndex.hpp>
+#include <FileIndexBuilder.hpp>
+#include <FileLas.hpp>
+#include <FileLasCompression.hpp>
+#include <FileLasWriter.hpp>
+#include <Time.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#define BENCHMARK_REPEAT 3
+
+enum Command
+{
+    COMMAND_NONE,
+    COMMAND_DECODE,
+    COMMAND_ENCODE,
+    COMMAND_COMPRESS,
+    COMMAND_MEMORY,
+    COMMAND_FILTER,
+    COMMAND_SCAN,
+    COMMAND_LOAD,
+    COMMAND_PREFETCH,
+    COMMAND_LOD,
+    COMMAND_SCHEDULE,
+    COMMAND_STRESS
+};
+
+void getarg(size_t *v, int &opt, int argc, char *argv[])
+{
+    opt++;
+    if (opt < argc)
+    {
+        *v = std::stoul(argv[opt]);
+    }
+}
+
+void getarg(const char **v, int &opt, int argc, char *argv[])
+{
+    opt++;
+    if (opt < argc)
+    {
+        *v = argv[opt];
+    }
+}
+
+/** Create LAS header and records with pseudo-random point data. */
+void createPoints(FileLas &las,
+                  std::vector<uint8_t> &buffer,
+                  uint8_t fmt,
+                  size_t n)
+{
+    std::memset(&las.header, 0, sizeof(las.header));
+    las.header.point_data_record_format = fmt;
+    las.header.point_data_record_length =
+        static_cast<uint16_t>(las.header.pointDataRecordLength3dForest());
+
+    size_t size = las.header.point_data_record_length;
+    buffer.resize(size * n);
+
+    FileLas::Point pt;
+    std::memset(&pt, 0, sizeof(pt));
+    pt.format = fmt;
+
+    std::srand(1);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        // Signed coordinates on both sides of the header offset
+        pt.x = std::rand() - (RAND_MAX / 2);
+        pt.y = std::rand() - (RAND_MAX / 2);
+        pt.z = (std::rand() % 100000) - 50000;
+        pt.intensity = static_cast<uint16_t>(std::rand());
+        pt.return_number = static_cast<uint8_t>(1 + std::rand() % 3);
+        pt.number_of_returns = 3;
+        pt.classification = static_cast<uint8_t>(std::rand() % 16);
+        pt.gps_time = static_cast<double>(i) * 0.001;
+        pt.red = static_cast<uint16_t>(std::rand());
+        pt.green = static_cast<uint16_t>(std::rand());
+        pt.blue = static_cast<uint16_t>(std::rand());
+        pt.user_layer = static_cast<uint32_t>(std::rand() % 8);
+
+        las.writePoint(buffer.data() + (size * i), pt);
+    }
+}
+
+double bestTime(double best, double t)
+{
+    if (best > 0 && best < t)
+    {
+        return best;
+    }
+
+    return t;
+}
+
+void printRate(const char *name, size_t n, double seconds)
+{
+    double rate = 0;
+    if (seconds > 0)
+    {
+        rate = static_cast<double>(n) / seconds * 1e-6;
+    }
+
+    std::cout << std::setw(12) << name << std::fixed << std::setprecision(1)
+              << std::setw(10) << rate << " Mpt/s" << std::endl;
+}
+
+void cmd_decode(size_t n)
+{
+    FileLas las;
+    std::vector<uint8_t> buffer;
+
+    std::vector<double> xyz(n * 3);
+    std::vector<uint16_t> intensity(n);
+    std::vector<uint8_t> returnNumber(n);
+    std::vector<uint8_t> numberOfReturns(n);
+    std::vector<uint8_t> classification(n);
+    std::vector<double> gpsTime(n);
+    std::vector<uint16_t> rgb(n * 3);
+    std::vector<uint32_t> layer(n);
+
+    std::cout << "decode " << n << " points" << std::endl;
+
+    for (uint8_t fmt = 0; fmt < 11; fmt++)
+    {
+        createPoints(las, buffer, fmt, n);
+        size_t size = las.header.point_data_record_length;
+
+        std::cout << "format " << static_cast<int>(fmt) << ", " << size
+                  << " bytes" << std::endl;
+
+        // Per point
+        FileLas::Point pt;
+        double best = 0;
+        for (size_t r = 0; r < BENCHMARK_REPEAT; r++)
+        {
+            double t1 = getRealTime();
+            for (size_t i = 0; i < n; i++)
+            {
+                las.readPoint(pt, buffer.data() + (size * i), fmt);
+                xyz[3 * i + 0] = static_cast<double>(pt.x);
+                xyz[3 * i + 1] = static_cast<double>(pt.y);
+                xyz[3 * i + 2] = static_cast<double>(pt.z);
+                intensity[i] = pt.intensity;
+                returnNumber[i] = pt.return_number;
+                numberOfReturns[i] = pt.number_of_returns;
+                classification[i] = pt.classification;
+                gpsTime[i] = pt.gps_time;
+                rgb[3 * i + 0] = pt.red;
+                rgb[3 * i + 1] = pt.green;
+                rgb[3 * i + 2] = pt.blue;
+                layer[i] = pt.user_layer;
+            }
+            best = bestTime(best, getRealTime() - t1);
+        }
+        printRate("point", n, best);
+
+        std::vector<double> reference = xyz;
+
+        // Columns
+        FileLas::Columns columns;
+        columns.xyz = xyz.data();
+        columns.intensity = intensity.data();
+        columns.returnNumber = returnNumber.data();
+        columns.numberOfReturns = numberOfReturns.data();
+        columns.classification = classification.data();
+        columns.gpsTime = gpsTime.data();
+        columns.rgb = rgb.data();
+        columns.userLayer = layer.data();
+
+        best = 0;
+        for (size_t r = 0; r < BENCHMARK_REPEAT; r++)
+        {
+            double t1 = getRealTime();
+            las.readPoints(columns, buffer.data(), n);
+            best = bestTime(best, getRealTime() - t1);
+        }
+        printRate("columns", n, best);
+
+        if (std::memcmp(reference.data(), xyz.data(), n * 3 * 8) != 0)
+        {
+            THROW("Decoded coordinates do not match");
+        }
+    }
+}
+
+void cmd_encode(size_t n)
+{
+    FileLas las;
+    std::vector<uint8_t> buffer;
+    std::vector<uint8_t> output;
+
+    std::vector<double> xyz(n * 3);
+    std::vector<uint16_t> intensity(n);
+    std::vector<uint8_t> returnNumber(n);
+    std::vector<uint8_t> numberOfReturns(n);
+    std::vector<uint8_t> classification(n);
+    std::vector<double> gpsTime(n);
+    std::vector<uint16_t> rgb(n * 3);
+    std::vector<uint32_t> layer(n);
+
+    FileLas::Columns columns;
+    columns.xyz = xyz.data();
+    columns.intensity = intensity.data();
+    columns.returnNumber = returnNumber.data();
+    columns.numberOfReturns = numberOfReturns.data();
+    columns.classification = classification.data();
+    columns.gpsTime = gpsTime.data();
+    columns.rgb = rgb.data();
+    columns.userLayer = layer.data();
+
+    std::string path = File::tmpname("benchmark.las");
+
+    std::cout << "encode " << n << " points" << std::endl;
+
+    for (uint8_t fmt = 0; fmt < 11; fmt++)
+    {
+        createPoints(las, buffer, fmt, n);
+        las.readPoints(columns, buffer.data(), n);
+        size_t size = las.header.point_data_record_length;
+        output.resize(buffer.size());
+
+        std::cout << "format " << static_cast<int>(fmt) << ", " << size
+                  << " bytes" << std::endl;
+
+        // Per point to file
+        FileLas::Point pt;
+        std::memset(&pt, 0, sizeof(pt));
+        pt.format = fmt;
+        double start = getRealTime();
+        FileLas file;
+        file.create(path);
+        file.header = las.header;
+        file.writeHeader();
+        for (size_t i = 0; i < n; i++)
+        {
+            pt.x = static_cast<int32_t>(xyz[3 * i + 0]);
+            pt.y = static_cast<int32_t>(xyz[3 * i + 1]);
+            pt.z = static_cast<int32_t>(xyz[3 * i + 2]);
+            pt.intensity = intensity[i];
+            pt.return_number = returnNumber[i];
+            pt.number_of_returns = numberOfReturns[i];
+            pt.classification = classification[i];
+            pt.gps_time = gpsTime[i];
+            pt.red = rgb[3 * i + 0];
+            pt.green = rgb[3 * i + 1];
+            pt.blue = rgb[3 * i + 2];
+            pt.user_layer = layer[i];
+            file.writePoint(pt);
+        }
+        file.close();
+        printRate("point", n, getRealTime() - start);
+
+        // Columns to memory
+        double best = 0;
+        for (size_t r = 0; r < BENCHMARK_REPEAT; r++)
+        {
+            double t1 = getRealTime();
+            las.writePoints(output.data(), columns, n);
+            best = bestTime(best, getRealTime() - t1);
+        }
+        printRate("columns", n, best);
+
+        if (output != buffer)
+        {
+            THROW("Encoded points do not match");
+        }
+
+        // Columns to file
+        start = getRealTime();
+        FileLasWriter writer;
+        writer.create(path, fmt);
+        writer.write(columns, n);
+        writer.close();
+        printRate("writer", n, getRealTime() - start);
+
+        FileLas input;
+        input.open(path);
+        input.readHeader();
+        if (input.header.number_of_point_records != n)
+        {
+            THROW("Written number of points does not match");
+        }
+        input.seekPointData();
+        input.file().read(output.data(), output.size());
+        input.close();
+
+        if (output != buffer)
+        {
+            THROW("Written points do not match");
+        }
+
+        // Round trip of coordinates below the offset with extents
+        std::vector<double> reference = xyz;
+        const FileLas::Header &hdr = input.header;
+        las.readPoints(columns, output.data(), n);
+        if (reference != xyz)
+        {
+            THROW("Written coordinates do not match");
+        }
+
+        for (size_t k = 0; k < 3; k++)
+        {
+            double min = xyz[k];
+            for (size_t i = 1; i < n; i++)
+            {
+                min = std::min(min, xyz[3 * i + k]);
+            }
+
+            double hdrMin = (k == 0) ? hdr.min_x
+                                     : ((k == 1) ? hdr.min_y : hdr.min_z);
+            if (min >= 0.0 || std::abs(min - hdrMin) > 1e-9)
+            {
+                THROW("Written extents do not match");
+            }
+        }
+    }
+
+    File::remove(path);
+}
+
+/** Create LAS file with a pseudo-random terrain surface. */
+void createTerrain(const std::string &path, size_t n)
+{
+    std::vector<double> xyz(n * 3);
+    std::vector<uint16_t> intensity(n);
+    std::vector<uint8_t> returnNumber(n);
+    std::vector<uint8_t> numberOfReturns(n);
+    std::vector<uint8_t> classification(n);
+    std::vector<double> gpsTime(n);
+    std::vector<uint16_t> rgb(n * 3);
+
+    std::srand(1);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        double x = static_cast<double>(std::rand() % 100000) * 0.001;
+        double y = static_cast<double>(std::rand() % 100000) * 0.001;
+        double z = 0.05 * x + 0.02 * y +
+                   static_cast<double>(std::rand() % 500) * 0.001;
+        xyz[3 * i + 0] = x;
+        xyz[3 * i + 1] = y;
+        xyz[3 * i + 2] = z;
+        intensity[i] = static_cast<uint16_t>(std::rand() % 4096);
+        returnNumber[i] = 1;
+        numberOfReturns[i] = 1;
+        classification[i] = static_cast<uint8_t>(2 + std::rand() % 2);
+        gpsTime[i] = static_cast<double>(i) * 1e-5;
+        uint16_t color = static_cast<uint16_t>(20000 + std::rand() % 8192);
+        rgb[3 * i + 0] = color;
+        rgb[3 * i + 1] = static_cast<uint16_t>(color + 4096);
+        rgb[3 * i + 2] = static_cast<uint16_t>(color - 8192);
+    }
+
+    FileLas::Columns columns;
+    columns.xyz = xyz.data();
+    columns.intensity = intensity.data();
+    columns.returnNumber = returnNumber.data();
+    columns.numberOfReturns = numberOfReturns.data();
+    columns.classification = classification.data();
+    columns.gpsTime = gpsTime.data();
+    columns.rgb = rgb.data();
+
+    FileLasWriter writer;
+    writer.create(path, 7, {0.001, 0.001, 0.001});
+    writer.write(columns, n);
+    writer.close();
+}
+
+/** Read all index nodes of indexed LAS file into buffer. */
+void readNodes(std::vector<uint8_t> &buffer, const std::string &path)
+{
+    const std::string pathIndex = FileIndexBuilder::extension(path);
+    FileIndex index;
+    index.read(pathIndex);
+
+    FileLas las;
+    las.open(path);
+    las.readHeader();
+
+    size_t size = las.header.point_data_record_length;
+    buffer.resize(static_cast<size_t>(las.header.number_of_point_records) *
+                  size);
+
+    for (size_t i = 0; i < index.size(); i++)
+    {
+        const FileIndex::Node *node = index.at(i);
+        uint8_t *ptr = buffer.data() + (node->from * size);
+
+        if (las.header.point_data_compressed)
+        {
+            FileLasCompression::readNode(ptr, las, pathIndex, *node);
+        }
+        else
+        {
+            las.seek(las.header.offset_to_point_data + (node->from * size));
+            las.file().read(ptr, node->size * size);
+        }
+    }
+
+    las.close();
+}
+
+/** Drop file from page cache, return false when not supported. */
+bool evictFile(const std::string &path)
+{
+#if defined(POSIX_FADV_DONTNEED)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        THROW("Can't open file '" + path + "' to drop it from page cache");
+    }
+    (void)::fdatasync(fd);
+    int rc = ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    (void)::close(fd);
+    return rc == 0;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+/** Read all index nodes of indexed LAS file after dropping it from cache. */
+double readNodesCold(std::vector<uint8_t> &buffer, const std::string &path)
+{
+    if (!evictFile(path) || !evictFile(FileIndexBuilder::extension(path)))
+    {
+        return -1.0;
+    }
+
+    double start = getRealTime();
+    readNodes(buffer, path);
+    return getRealTime() - start;
+}
+
+void cmd_compress(const char *inputPath, size_t n)
+{
+    std::string path;
+    if (inputPath)
+    {
+        path = inputPath;
+    }
+    else
+    {
+        path = File::tmpname("benchmark.las");
+        createTerrain(path, n);
+    }
+
+    // Index with raw and compressed point data
+    FileIndexBuilder::Settings settings;
+    std::string pathRaw = File::tmpname("benchmark_raw.las");
+    FileIndexBuilder::index(pathRaw, path, settings);
+
+    settings.compressed = true;
+    std::string pathCompressed = File::tmpname("benchmark_compressed.las");
+    FileIndexBuilder::index(pathCompressed, path, settings);
+
+    uint64_t sizeRaw = File::fileSize(pathRaw);
+    uint64_t sizeCompressed = File::fileSize(pathCompressed);
+
+    FileLas las;
+    las.open(pathRaw);
+    las.readHeader();
+    las.close();
+    n = static_cast<size_t>(las.header.number_of_point_records);
+
+    std::cout << "compress " << n << " points, format "
+              << static_cast<int>(las.header.point_data_record_format)
+              << std::endl;
+    std::cout << std::setw(12) << "raw" << std::setw(10) << sizeRaw
+              << " bytes" << std::endl;
+    std::cout << std::setw(12) << "compressed" << std::setw(10)
+              << sizeCompressed << " bytes, " << std::fixed
+              << std::setprecision(1)
+              << 100.0 * static_cast<double>(sizeCompressed) /
+                     static_cast<double>(sizeRaw)
+              << "%" << std::endl;
+
+    // Read all nodes from page cache
+    std::vector<uint8_t> raw;
+    std::vector<uint8_t> decompressed;
+
+    double best = 0;
+    for (size_t r = 0; r < BENCHMARK_REPEAT; r++)
+    {
+        double start = getRealTime();
+        readNodes(raw, pathRaw);
+        best = bestTime(best, getRealTime() - start);
+    }
+    printRate("read", n, best);
+
+    best = 0;
+    for (size_t r = 0; r < BENCHMARK_REPEAT; r++)
+    {
+        double start = getRealTime();
+        readNodes(decompressed, pathCompressed);
+        best = bestTime(best, getRealTime() - start);
+    }
+    printRate("decompress", n, best);
+
+    if (raw != decompressed)
+    {
+        THROW("Decompressed points do not match");
+    }
+
+    // Read all nodes from disk, cold page cache
+    double readCold = readNodesCold(raw, pathRaw);
+    double decompressCold = readNodesCold(decompressed, pathCompressed);
+    if (readCold < 0 || decompressCold < 0)
+    {
+        std::cout << "cold read is not supported on this system"
+                  << std::endl;
+    }
+    else
+    {
+        printRate("read cold", n, readCold);
+        printRate("decomp cold", n, decompressCold);
+    }
+
+    if (raw != decompressed)
+    {
+        THROW("Decompressed points do not match");
+    }
+
+    // Cleanup
+    File::remove(pathRaw);
+    File::remove(FileIndexBuilder::extension(pathRaw));
+    File::remove(pathCompressed);
+    File::remove(FileIndexBuilder::extension(pathCompressed));
+    if (!inputPath)
+    {
+        File::remove(path);
+    }
+}
+
+void printMemory(const char *name, size_t bytes, size_t n)
+{
+    std::cout << std::setw(12) << name << std::setw(12) << bytes
+              << " bytes, " << std::fixed << std::setprecision(1)
+              << static_cast<double>(bytes) / static_cast<double>(n)
+              << " bytes/pt" << std::endl;
+}
+
+void printTileMemory(EditorBase &editor, uint32_t mask)
+{
+    size_t n = 0;
+    size_t total = 0;
+    size_t column[EditorTile::COLUMN_COUNT] = {};
+
+    for (size_t d = 0; d < editor.dataSetSize(); d++)
+    {
+        size_t nTiles = editor.dataSet(d).index.size();
+        for (size_t t = 0; t < nTiles; t++)
+        {
+            EditorTile *tile = editor.tile(d, t, mask);
+            if (!tile)
+            {
+                continue;
+            }
+
+            n += tile->renderXyz.size() / 3;
+            total += tile->memorySize();
+            for (size_t c = 0; c < EditorTile::COLUMN_COUNT; c++)
+            {
+                EditorTile::Column col = static_cast<EditorTile::Column>(c);
+                column[c] += tile->memorySize(col);
+            }
+        }
+    }
+
+    if (n < 1)
+    {
+        THROW("No resident points");
+    }
+
+    const char *names[EditorTile::COLUMN_COUNT] = {"xyz",
+                                                   "render",
+                                                   "intensity",
+                                                   "rgb",
+                                                   "rgbOutput",
+                                                   "attrib",
+                                                   "gpsTime",
+                                                   "layer"};
+    for (size_t c = 0; c < EditorTile::COLUMN_COUNT; c++)
+    {
+        printMemory(names[c], column[c], n);
+    }
+    printMemory("total", total, n);
+}
+
+/** Compare vertex data of resident tiles with float vertex data. */
+void printRenderMemory(EditorBase &editor)
+{
+    size_t n = 0;
+    size_t quantized = 0;
+
+    for (size_t d = 0; d < editor.dataSetSize(); d++)
+    {
+        size_t nTiles = editor.dataSet(d).index.size();
+        for (size_t t = 0; t < nTiles; t++)
+        {
+            EditorTile *tile = editor.tile(d, t);
+            if (!tile)
+            {
+                continue;
+            }
+
+            n += tile->renderXyz.size() / 3;
+            quantized += tile->renderXyz.capacity() * sizeof(int16_t) +
+                         tile->view->rgba.capacity() * sizeof(uint8_t);
+        }
+    }
+
+    if (n < 1)
+    {
+        THROW("No resident points");
+    }
+
+    // Vertex data drawn from float positions and float colors
+    size_t floats = n * (3 * sizeof(float) + 3 * sizeof(float));
+
+    printMemory("float", floats, n);
+    printMemory("quantized", quantized, n);
+}
+
+/** Load all viewports, rendering is replaced by advancing frames. */
+void renderViews(EditorBase &editor, size_t nViewports)
+{
+    while (!editor.loadView())
+    {
+        for (size_t v = 0; v < nViewports; v++)
+        {
+            for (size_t i = 0; i < editor.tileViewSize(v); i++)
+            {
+                editor.tileViewFrame(v, i).nextFrame();
+            }
+        }
+
+        // Give the loader time like the render thread does
+        if (editor.numberOfLoaderThreads() > 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+void printViewportMemory(EditorBase &editor, size_t nViewports)
+{
+    editor.setNumberOfViewports(nViewports);
+
+    // Views from the corners of the boundary toward the center
+    const Aabb<double> &box = editor.boundaryView();
+    for (size_t v = 0; v < nViewports; v++)
+    {
+        Camera camera;
+        camera.eye[0] = static_cast<float>((v & 1U) ? box.max(0) : box.min(0));
+        camera.eye[1] = static_cast<float>((v & 2U) ? box.max(1) : box.min(1));
+        camera.eye[2] = static_cast<float>(box.max(2));
+        editor.updateCamera(v, camera);
+    }
+
+    renderViews(editor, nViewports);
+
+    size_t nView = 0;
+    for (size_t v = 0; v < nViewports; v++)
+    {
+        nView += editor.tileViewSize(v);
+    }
+
+    const EditorTileStore &store = editor.tileStore();
+    std::cout << std::setw(12) << nViewports << " viewports, " << nView
+              << " tiles in views, " << store.size() << " tiles resident, "
+              << store.memorySize() << " bytes" << std::endl;
+}
+
+void printCacheStatistics(const EditorTileStore &store)
+{
+    const EditorTileStore::Statistics &stats = store.statistics();
+    std::cout << std::setw(12) << "cache" << " hits " << stats.hits
+              << ", misses " << stats.misses << ", evictions "
+              << stats.evictions << ", resident " << stats.residentTiles
+              << " tiles " << stats.residentBytes << " bytes, pinned "
+              << stats.pinnedTiles << " tiles, budget " << stats.budget
+              << " bytes" << std::endl;
+}
+
+void cmd_memory(const char *inputPath)
+{
+    if (!inputPath)
+    {
+        THROW("Missing input project or data set");
+    }
+
+    EditorBase editor;
+    editor.open(inputPath);
+
+    std::cout << "memory, required columns" << std::endl;
+    printTileMemory(editor, 0);
+
+    std::cout << "memory, render data" << std::endl;
+    printRenderMemory(editor);
+
+    std::cout << "memory, all columns" << std::endl;
+    printTileMemory(editor, (1U << EditorTile::COLUMN_COUNT) - 1U);
+
+    // Viewports share tiles through the tile store
+    EditorBase viewer;
+    viewer.open(inputPath);
+
+    std::cout << "memory, viewports" << std::endl;
+    printViewportMemory(viewer, 1);
+    printViewportMemory(viewer, 4);
+    printCacheStatistics(viewer.tileStore());
+
+    // Without budget only tiles in use stay resident
+    EditorSettings::Cache cache;
+    cache.setSize(0);
+    viewer.setSettingsCache(cache);
+    printViewportMemory(viewer, 0);
+    printTileMemory(viewer, 0);
+    printCacheStatistics(viewer.tileStore());
+}
+
+/** Create indexed data set with many tiles, return path to it. */
+std::string createTiles(std::string &pathTerrain, size_t n, size_t nTiles)
+{
+    pathTerrain = File::tmpname("benchmark.las");
+    createTerrain(pathTerrain, n);
+
+    FileIndexBuilder::Settings settings;
+    settings.maxSize1 = n / nTiles + 1;
+    std::string path = File::tmpname("benchmark_tiles.las");
+    FileIndexBuilder::index(path, pathTerrain, settings);
+
+    return path;
+}
+
+void removeTiles(const std::string &pathTerrain, const std::string &path)
+{
+    File::remove(pathTerrain);
+    File::remove(path);
+    File::remove(FileIndexBuilder::extension(path));
+}
+
+/** Show clipped part of the data set in viewport 0. */
+void viewClip(EditorBase &editor, double x1, double y1, double x2, double y2)
+{
+    const Aabb<double> &box = editor.boundary();
+    double dx = box.max(0) - box.min(0);
+    double dy = box.max(1) - box.min(1);
+
+    ClipFilter clipFilter = editor.clipFilter();
+    clipFilter.box.set(box.min(0) + x1 * dx,
+                       box.min(1) + y1 * dy,
+                       box.min(2),
+                       box.min(0) + x2 * dx,
+                       box.min(1) + y2 * dy,
+                       box.max(2));
+    clipFilter.enabled = ClipFilter::TYPE_BOX;
+    editor.setClipFilter(clipFilter);
+    editor.tileViewClear(EditorTile::filterMask(EditorTile::FILTER_CLIP));
+
+    Camera camera;
+    editor.updateCamera(0, camera);
+    renderViews(editor, 1);
+}
+
+void cmd_scan(size_t n)
+{
+    // Data set with many tiles
+    std::string pathTerrain;
+    std::string path = createTiles(pathTerrain, n, 64);
+
+    EditorBase editor;
+    editor.addFile(File::currentPath() + "/" + path, false);
+    const EditorTileStore &store = editor.tileStore();
+
+    // Interactive working set, the user switches between two views
+    for (size_t r = 0; r < 2; r++)
+    {
+        viewClip(editor, 0.0, 0.0, 0.3, 0.3);
+        viewClip(editor, 0.7, 0.7, 1.0, 1.0);
+    }
+
+    // The budget holds just the working set
+    EditorSettings::Cache cache;
+    cache.setSize(store.memorySize());
+    editor.setSettingsCache(cache);
+    size_t nWorkingSet = store.size();
+
+    // Full data set pass of a plugin
+    size_t nTiles = editor.dataSet(0).index.size();
+    double start = getRealTime();
+    for (size_t t = 0; t < nTiles; t++)
+    {
+        (void)editor.tile(0, t);
+    }
+    double seconds = getRealTime() - start;
+
+    // Back to the first view
+    EditorTileStore::Statistics before = store.statistics();
+    viewClip(editor, 0.0, 0.0, 0.3, 0.3);
+    const EditorTileStore::Statistics &after = store.statistics();
+    uint64_t hits = after.hits - before.hits;
+    uint64_t total = hits + after.misses - before.misses;
+
+    std::cout << "scan " << nTiles << " tiles, working set " << nWorkingSet
+              << " tiles" << std::endl;
+    printRate("scan", n, seconds);
+    std::cout << std::setw(12) << "view" << " hits " << hits << " of "
+              << total << " tiles, " << std::fixed << std::setprecision(1)
+              << 100.0 * static_cast<double>(hits) /
+                     static_cast<double>(total)
+              << "%" << std::endl;
+    printCacheStatistics(store);
+
+    // Cleanup
+    editor.close();
+    removeTiles(pathTerrain, path);
+}
+
+void cmd_load(size_t n)
+{
+    std::string pathTerrain;
+    std::string path = createTiles(pathTerrain, n, 64);
+    path = File::currentPath() + "/" + path;
+
+    size_t nThreadsMax = std::thread::hardware_concurrency();
+    if (nThreadsMax < 4)
+    {
+        nThreadsMax = 4;
+    }
+
+    std::cout << "load " << n << " points, "
+              << std::thread::hardware_concurrency() << " cores" << std::endl;
+
+    size_t nVisibleFirst = 0;
+    for (size_t nThreads = 0; nThreads <= nThreadsMax;
+         nThreads = (nThreads == 0) ? 1 : nThreads * 2)
+    {
+        // Time to full detail after camera move with empty cache
+        EditorBase editor;
+        editor.addFile(path, false);
+        editor.setNumberOfLoaderThreads(nThreads);
+
+        double start = getRealTime();
+        Camera camera;
+        editor.updateCamera(0, camera);
+        renderViews(editor, 1);
+        double seconds = getRealTime() - start;
+
+        size_t nVisible = 0;
+        for (size_t i = 0; i < editor.tileViewSize(0); i++)
+        {
+            nVisible += editor.tileView(0, i).view->indices.size();
+        }
+
+        if (nThreads == 0)
+        {
+            nVisibleFirst = nVisible;
+        }
+        else if (nVisible != nVisibleFirst)
+        {
+            THROW("Loaded points do not match");
+        }
+
+        std::string name = std::to_string(nThreads) + " threads";
+        printRate(name.c_str(), nVisible, seconds);
+    }
+
+    removeTiles(pathTerrain, path);
+}
+
+/** Fly along the data set, return demand misses of the tile store. */
+uint64_t flyThrough(const std::string &path,
+                    size_t pointBudget,
+                    bool prefetch)
+{
+    EditorBase editor;
+    editor.addFile(path, false);
+    editor.setNumberOfLoaderThreads(2);
+
+    EditorSettings::Cache cache = editor.settings().cache();
+    cache.setPrefetchEnabled(prefetch);
+    editor.setSettingsCache(cache);
+
+    // Part of the data set is in view
+    EditorSettings::View view = editor.settings().view();
+    view.setPointBudget(pointBudget);
+    editor.setSettingsView(view);
+
+    const Aabb<double> &box = editor.boundaryView();
+    const size_t nSteps = 20;
+
+    double start = getRealTime();
+    for (size_t i = 0; i <= nSteps; i++)
+    {
+        double t = static_cast<double>(i) / static_cast<double>(nSteps);
+
+        Camera camera;
+        camera.eye[0] =
+            static_cast<float>(box.min(0) + t * (box.max(0) - box.min(0)));
+        camera.eye[1] = static_cast<float>(box.getCenter()[1]);
+        camera.eye[2] = static_cast<float>(box.max(2));
+        editor.updateCamera(0, camera);
+        renderViews(editor, 1);
+
+        // Frame time of the user interaction
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    }
+    double seconds = getRealTime() - start;
+
+    const EditorTileStore::Statistics &stats = editor.tileStore().statistics();
+    std::cout << (prefetch ? "prefetch" : "no prefetch") << std::endl;
+    std::cout << std::setw(12) << "time" << std::fixed << std::setprecision(2)
+              << std::setw(10) << seconds << " s" << std::endl;
+    printCacheStatistics(editor.tileStore());
+    std::cout << std::setw(12) << "prefetch" << " tiles "
+              << stats.prefetchTiles << ", hits " << stats.prefetchHits
+              << ", cancelled " << stats.prefetchCancelled << ", wasted "
+              << stats.prefetchWastedTiles << " tiles "
+              << stats.prefetchWastedBytes << " bytes" << std::endl;
+
+    return stats.misses;
+}
+
+void cmd_prefetch(size_t n)
+{
+    std::string pathTerrain;
+    std::string path = createTiles(pathTerrain, n, 1024);
+    path = File::currentPath() + "/" + path;
+
+    uint64_t missesWithout = flyThrough(path, n / 5, false);
+    uint64_t missesWith = flyThrough(path, n / 5, true);
+
+    std::cout << "demand misses " << missesWithout << " without prefetch, "
+              << missesWith << " with prefetch" << std::endl;
+
+    removeTiles(pathTerrain, path);
+}
+
+void cmd_lod(size_t n)
+{
+    std::string pathTerrain;
+    std::string path = createTiles(pathTerrain, n, 1024);
+    path = File::currentPath() + "/" + path;
+
+    EditorBase editor;
+    editor.addFile(path, false);
+    const EditorDataSet &dataSet = editor.dataSet(0);
+    const Aabb<double> &box = editor.boundaryView();
+    double extent = box.max(0) - box.min(0);
+
+    std::cout << "lod " << n << " points, " << dataSet.index.size()
+              << " tiles" << std::endl;
+
+    const size_t budgets[3] = {n / 100, n / 10, n};
+    const double heights[3] = {0.1, 1.0, 10.0};
+
+    for (size_t b = 0; b < 3; b++)
+    {
+        EditorSettings::View view = editor.settings().view();
+        view.setPointBudget(budgets[b]);
+        editor.setSettingsView(view);
+
+        for (size_t h = 0; h < 3; h++)
+        {
+            double z = box.max(2) + heights[h] * extent;
+
+            Camera camera;
+            camera.eye.set(static_cast<float>(box.min(0)),
+                           static_cast<float>(box.min(1)),
+                           static_cast<float>(z));
+            camera.center.set(static_cast<float>(box.getCenter()[0]),
+                              static_cast<float>(box.getCenter()[1]),
+                              static_cast<float>(box.min(2)));
+
+            double start = getRealTime();
+            editor.updateCamera(0, camera);
+            double seconds = getRealTime() - start;
+
+            size_t nPoints = 0;
+            for (size_t i = 0; i < editor.tileViewSize(0); i++)
+            {
+                size_t tileId = editor.tileView(0, i).tileId;
+                nPoints += static_cast<size_t>(dataSet.index.at(tileId)->size);
+            }
+
+            std::cout << std::setw(12) << budgets[b] << " budget, height "
+                      << std::fixed << std::setprecision(1) << heights[h]
+                      << ", " << editor.tileViewSize(0) << " tiles, "
+                      << nPoints << " points, " << std::setprecision(3)
+                      << seconds * 1000.0 << " ms" << std::endl;
+        }
+    }
+
+    // Camera moves in small steps as during user interaction
+    EditorSettings::View view = editor.settings().view();
+    view.setPointBudget(n / 10);
+    editor.setSettingsView(view);
+
+    const size_t nUpdates = 1000;
+    double z = box.max(2) + 0.5 * extent;
+
+    double start = getRealTime();
+    for (size_t i = 0; i < nUpdates; i++)
+    {
+        double t = static_cast<double>(i) / static_cast<double>(nUpdates);
+
+        Camera camera;
+        camera.eye.set(static_cast<float>(box.min(0) + t * extent),
+                       static_cast<float>(box.min(1)),
+                       static_cast<float>(z));
+        camera.center.set(static_cast<float>(box.getCenter()[0]),
+                          static_cast<float>(box.getCenter()[1]),
+                          static_cast<float>(box.min(2)));
+        editor.updateCamera(0, camera);
+    }
+    double seconds = getRealTime() - start;
+
+    std::cout << std::setw(12) << nUpdates << " camera updates, "
+              << std::fixed << std::setprecision(3)
+              << seconds * 1.0e6 / static_cast<double>(nUpdates)
+              << " us per update" << std::endl;
+
+    editor.close();
+    removeTiles(pathTerrain, path);
+}
+
+/** Advance frames of the view like the viewport widget draws them.
+    Returns true when the whole view is drawn.
+*/
+bool paintView(EditorBase &editor, EditorScheduler &scheduler, size_t v)
+{
+    std::shared_ptr<EditorCache::Snapshot> view = editor.tileViewSnapshot(v);
+    bool firstFrame = view->tiles.empty();
+    bool finished = true;
+
+    for (size_t i = 0; i < view->tiles.size(); i++)
+    {
+        EditorCache::Frame &frame = view->frames[i];
+        if (view->tiles[i]->snapshot() && !frame.isFinished())
+        {
+            if (i == 0 && frame.isStarted())
+            {
+                firstFrame = true;
+            }
+            frame.nextFrame();
+        }
+
+        if (!frame.isFinished())
+        {
+            finished = false;
+        }
+    }
+
+    if (firstFrame)
+    {
+        scheduler.firstPixel(v);
+    }
+
+    return finished;
+}
+
+/** Render task of the viewer without the user interface.
+    Same events as the render thread of the application, the viewport is
+    painted by the task itself.
+*/
+class RenderTask
+{
+public:
+    RenderTask(EditorBase &editor, EditorScheduler &scheduler)
+        : editor_(editor),
+          scheduler_(scheduler),
+          active_(false),
+          pending_(false),
+          suspended_(false),
+          steps_(0)
+    {
+        queue_.setNumberOfThreads(1);
+    }
+
+    void request(size_t viewportId, const Camera &camera)
+    {
+        scheduler_.request(viewportId, camera);
+        schedule();
+    }
+
+    void schedule()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_ = true;
+        if (!active_ && !suspended_)
+        {
+            push();
+        }
+    }
+
+    /** The task is not scheduled again until restart(). */
+    void cancel()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            suspended_ = true;
+        }
+        queue_.cancel();
+    }
+
+    void restart()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            suspended_ = false;
+        }
+        scheduler_.repeat();
+        schedule();
+    }
+
+    void stop() { queue_.setNumberOfThreads(0); }
+
+    uint64_t steps() const { return steps_; }
+    std::mutex &editorMutex() { return editorMutex_; }
+
+protected:
+    EditorBase &editor_;
+    EditorScheduler &scheduler_;
+    std::vector<EditorScheduler::Request> requests_;
+    std::mutex editorMutex_;
+    std::mutex mutex_;
+    bool active_;
+    bool pending_;
+    bool suspended_;
+    std::atomic<uint64_t> steps_;
+    EditorTaskQueue queue_;
+
+    void push()
+    {
+        active_ = true;
+        queue_.push([this](const EditorTaskQueue::Token &) { return step(); },
+                    EditorTaskQueue::PRIORITY_NORMAL,
+                    [this](bool canceled) { finished(canceled); });
+    }
+
+    bool step()
+    {
+        steps_++;
+
+        if (scheduler_.take(requests_))
+        {
+            std::lock_guard<std::mutex> lock(editorMutex_);
+            for (const auto &it : requests_)
+            {
+                editor_.updateCamera(it.viewportId, it.camera);
+            }
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_ = false;
+        }
+
+        bool ret;
+        {
+            std::lock_guard<std::mutex> lock(editorMutex_);
+            ret = editor_.loadView();
+        }
+
+        if (ret)
+        {
+            scheduler_.fullDetail();
+        }
+        else if (paintView(editor_, scheduler_, 0))
+        {
+            // The viewport has drawn its whole view
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_ = true;
+        }
+
+        return true;
+    }
+
+    void finished(bool canceled)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_ = false;
+        if (pending_ && !canceled && !suspended_)
+        {
+            push();
+        }
+    }
+};
+
+/** Move the camera with input events, optionally wait for each update. */
+void schedule(const std::string &path, bool wait)
+{
+    EditorBase editor;
+    editor.addFile(path, false);
+    editor.setNumberOfLoaderThreads(2);
+
+    EditorSettings::View view = editor.settings().view();
+    view.setPointBudget(editor.dataSet(0).index.at(0)->size * 20);
+    editor.setSettingsView(view);
+
+    // Render task, woken by input events and by tiles from the loader
+    EditorScheduler scheduler;
+    RenderTask task(editor, scheduler);
+    editor.setLoaderCallback([&task]() { task.schedule(); });
+
+    // Input events from the user interface
+    const Aabb<double> &box = editor.boundaryView();
+    const size_t nEvents = 200;
+    const size_t nBurst = 10;
+    double inputMax = 0;
+    double inputTotal = 0;
+
+    for (size_t i = 0; i <= nEvents; i++)
+    {
+        double t = static_cast<double>(i) / static_cast<double>(nEvents);
+
+        Camera camera;
+        camera.eye[0] =
+            static_cast<float>(box.min(0) + t * (box.max(0) - box.min(0)));
+        camera.eye[1] = static_cast<float>(box.getCenter()[1]);
+        camera.eye[2] = static_cast<float>(box.max(2));
+
+        double start = getRealTime();
+        task.request(0, camera);
+        if (wait)
+        {
+            // Handshake with the render thread for each event
+            while (true)
+            {
+                EditorScheduler::Statistics stats = scheduler.statistics();
+                if (stats.updates + stats.coalesced == stats.requests)
+                {
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+        double seconds = getRealTime() - start;
+
+        inputTotal += seconds;
+        if (seconds > inputMax)
+        {
+            inputMax = seconds;
+        }
+
+        // Events without the handshake arrive in bursts, faster than the
+        // render task can take them
+        if (wait || (i % nBurst) == nBurst - 1)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+
+    // Wait for the full detail of the last camera
+    while (!scheduler.isIdle())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // Nothing runs while the view does not change
+    uint64_t steps = task.steps();
+    std::clock_t idleStart = std::clock();
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    double idleCpu = static_cast<double>(std::clock() - idleStart) /
+                     static_cast<double>(CLOCKS_PER_SEC);
+    uint64_t idleSteps = task.steps() - steps;
+
+    editor.setNumberOfLoaderThreads(0);
+    task.stop();
+    editor.close();
+
+    EditorScheduler::Statistics stats = scheduler.statistics();
+    std::cout << (wait ? "wait for each event" : "coalesce events")
+              << std::endl;
+    std::cout << std::setw(12) << "events" << " " << stats.requests
+              << ", updates " << stats.updates << ", coalesced "
+              << stats.coalesced << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::setw(12) << "input" << " avg "
+              << inputTotal * 1.0e6 / static_cast<double>(nEvents + 1)
+              << " us, max " << inputMax * 1.0e6 << " us" << std::endl;
+    std::cout << std::setw(12) << "first pixel" << " avg "
+              << stats.firstPixel.average() * 1000.0 << " ms, max "
+              << stats.firstPixel.max * 1000.0 << " ms" << std::endl;
+    std::cout << std::setw(12) << "full detail" << " avg "
+              << stats.fullDetail.average() * 1000.0 << " ms, max "
+              << stats.fullDetail.max * 1000.0 << " ms, last "
+              << stats.fullDetail.last * 1000.0 << " ms" << std::endl;
+    std::cout << std::setw(12) << "idle" << " cpu " << idleCpu * 1000.0
+              << " ms in 500 ms, " << idleSteps << " steps" << std::endl;
+
+    if (!wait && (stats.coalesced == 0 || stats.updates >= stats.requests))
+    {
+        THROW("Input events were not coalesced");
+    }
+}
+
+void cmd_schedule(size_t n)
+{
+    std::string pathTerrain;
+    std::string path = createTiles(pathTerrain, n, 1024);
+    path = File::currentPath() + "/" + path;
+
+    schedule(path, true);
+    schedule(path, false);
+
+    removeTiles(pathTerrain, path);
+}
+
+void cmd_stress(size_t n)
+{
+    std::string pathTerrain;
+    std::string path = createTiles(pathTerrain, n, 1024);
+    path = File::currentPath() + "/" + path;
+
+    EditorBase editor;
+    editor.addFile(path, false);
+    editor.setNumberOfLoaderThreads(2);
+
+    EditorSettings::View view = editor.settings().view();
+    view.setPointBudget(n / 4);
+    editor.setSettingsView(view);
+
+    std::vector<FileIndex::Selection> selection;
+    editor.select(selection);
+
+    // Render task, loader workers filter tiles without the editor lock
+    EditorScheduler scheduler;
+    RenderTask task(editor, scheduler);
+    editor.setLoaderCallback([&task]() { task.schedule(); });
+    std::mutex &mutex = task.editorMutex();
+
+    const Aabb<double> &box = editor.boundaryView();
+    std::atomic<bool> exit(false);
+    std::atomic<bool> failed(false);
+    std::atomic<uint64_t> nRender(0);
+    std::atomic<uint64_t> nPaint(0);
+    std::atomic<uint64_t> nPlugin(0);
+    uint64_t nClear = 0;
+
+    // Camera input, requests are coalesced by the render task
+    std::thread render([&]() {
+        std::srand(1);
+        while (!exit)
+        {
+            double tx = static_cast<double>(std::rand() % 100) * 0.01;
+            double ty = static_cast<double>(std::rand() % 100) * 0.01;
+
+            Camera camera;
+            camera.eye[0] =
+                static_cast<float>(box.min(0) + tx * (box.max(0) - box.min(0)));
+            camera.eye[1] =
+                static_cast<float>(box.min(1) + ty * (box.max(1) - box.min(1)));
+            camera.eye[2] = static_cast<float>(box.max(2));
+
+            task.request(0, camera);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+            nRender++;
+        }
+    });
+
+    // Painting, published snapshots without the editor lock
+    std::thread paint([&]() {
+        while (!exit)
+        {
+            std::shared_ptr<EditorCache::Snapshot> snapshot =
+                editor.tileViewSnapshot(0);
+
+            for (size_t i = 0; i < snapshot->tiles.size(); i++)
+            {
+                const EditorTile &tile = *snapshot->tiles[i];
+                EditorCache::Frame &frame = snapshot->frames[i];
+                std::shared_ptr<const EditorTile::View> tileView =
+                    tile.snapshot();
+
+                if (tileView && !frame.isFinished())
+                {
+                    // Each visible point has coordinates and color
+                    int sum = 0;
+                    for (const auto &idx : tileView->indices)
+                    {
+                        size_t j = static_cast<size_t>(idx);
+                        if (j * 3 + 2 >= tile.renderXyz.size() ||
+                            j * 4 + 3 >= tileView->rgba.size())
+                        {
+                            failed = true;
+                            break;
+                        }
+                        sum += tile.renderXyz[j * 3 + 2] *
+                               tileView->rgba[j * 4 + 3];
+                    }
+                    (void)sum;
+
+                    frame.nextFrame();
+                }
+            }
+
+            nPaint++;
+            std::this_thread::yield();
+        }
+    });
+
+    // Plugin, working cache tiles under the editor lock. Plugins share the
+    // tile store with the viewports, they are not lock free.
+    std::thread plugin([&]() {
+        const uint32_t columns =
+            EditorTile::columnMask(EditorTile::COLUMN_ATTRIB);
+        size_t i = 0;
+        while (!exit && !selection.empty())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                const FileIndex::Selection &sel =
+                    selection[i % selection.size()];
+                EditorTile *tile = editor.tile(sel.id, sel.idx, columns);
+                if (tile)
+                {
+                    tile->copyOnWrite();
+                    const Vector3<float> half(0.5F, 1.0F, 1.0F);
+                    for (const auto &idx : tile->view->indices)
+                    {
+                        tile->view->multiplyColor(idx, half);
+                    }
+                    tile->publish();
+                }
+            }
+
+            i++;
+            nPlugin++;
+            std::this_thread::yield();
+        }
+    });
+
+    // User interface, filter changes while the threads are canceled
+    const Aabb<double> &boundary = editor.boundary();
+    double start = getRealTime();
+    while (getRealTime() - start < 2.0)
+    {
+        task.cancel();
+        editor.cancelLoader();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            EditorTile::Filter filter = EditorTile::FILTER_COLOR;
+            switch (nClear % 4)
+            {
+                case 0:
+                {
+                    EditorClassification classification =
+                        editor.classification();
+                    classification.setEnabled(!classification.isEnabled());
+                    if (classification.size() > 2)
+                    {
+                        classification.setEnabled(
+                            2,
+                            !classification.isEnabled(2));
+                    }
+                    editor.setClassification(classification);
+                    filter = EditorTile::FILTER_CLASSIFICATION;
+                    break;
+                }
+                case 1:
+                {
+                    EditorLayers layers = editor.layers();
+                    layers.setEnabled(!layers.isEnabled());
+                    if (layers.size() > 0)
+                    {
+                        layers.setEnabled(0, !layers.isEnabled(0));
+                    }
+                    editor.setLayers(layers);
+                    filter = EditorTile::FILTER_LAYERS;
+                    break;
+                }
+                case 2:
+                {
+                    ClipFilter clipFilter = editor.clipFilter();
+                    double t = static_cast<double>(nClear % 50) * 0.01;
+                    double dx = t * (boundary.max(0) - boundary.min(0));
+                    double dy = t * (boundary.max(1) - boundary.min(1));
+                    clipFilter.box.set(boundary.min(0) + dx,
+                                       boundary.min(1),
+                                       boundary.min(2),
+                                       boundary.max(0),
+                                       boundary.max(1) - dy,
+                                       boundary.max(2));
+                    clipFilter.enabled = ClipFilter::TYPE_BOX;
+                    editor.setClipFilter(clipFilter);
+                    filter = EditorTile::FILTER_CLIP;
+                    break;
+                }
+                default:
+                    break;
+            }
+            editor.tileViewClear(EditorTile::filterMask(filter));
+        }
+
+        task.restart();
+        nClear++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    exit = true;
+    render.join();
+    paint.join();
+    plugin.join();
+
+    task.cancel();
+    editor.setNumberOfLoaderThreads(0);
+    task.stop();
+
+    std::cout << "stress " << nRender << " camera updates, "
+              << nPaint << " paints, " << nPlugin << " plugin steps, "
+              << nClear << " filter changes" << std::endl;
+
+    editor.close();
+    removeTiles(pathTerrain, path);
+
+    if (failed)
+    {
+        THROW("Painted tile snapshot is not consistent");
+    }
+}
+
+/** Reference filter with separate scalar passes over point indices. */
+void filterScalar(std::vector<unsigned int> &indices,
+                  const EditorTile &tile,
+                  const Aabb<double> &clipBox,
+                  const EditorClassification &classification,
+                  const EditorLayers &layers)
+{
+    size_t n = tile.xyz.size() / 3;
+    size_t nSelected = 0;
+
+    indices.resize(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        double x = tile.origin[0] + static_cast<double>(tile.xyz[3 * i + 0]);
+        double y = tile.origin[1] + static_cast<double>(tile.xyz[3 * i + 1]);
+        double z = tile.origin[2] + static_cast<double>(tile.xyz[3 * i + 2]);
+
+        if (clipBox.isInside(x, y, z))
+        {
+            indices[nSelected++] = static_cast<unsigned int>(i);
+        }
+    }
+    indices.resize(nSelected);
+
+    nSelected = 0;
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        if (classification.isEnabled(tile.attrib[indices[i]].classification))
+        {
+            indices[nSelected++] = indices[i];
+        }
+    }
+    indices.resize(nSelected);
+
+    nSelected = 0;
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        if (layers.isIdEnabled(tile.layer[indices[i]]))
+        {
+            indices[nSelected++] = indices[i];
+        }
+    }
+    indices.resize(nSelected);
+}
+
+void cmd_filter(size_t n)
+{
+    // Tile with pseudo-random point data
+    EditorTile tile;
+    tile.origin.set(1000.0, 2000.0, 300.0);
+    tile.xyz.resize(n * 3);
+    tile.attrib.resize(n);
+    tile.layer.resize(n);
+
+    std::srand(1);
+    for (size_t i = 0; i < n * 3; i++)
+    {
+        tile.xyz[i] = static_cast<float>(std::rand() % 100000) * 0.001F;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        tile.attrib[i].classification = static_cast<uint8_t>(std::rand() % 16);
+        tile.layer[i] = static_cast<uint32_t>(std::rand() % 16);
+    }
+
+    // Filters keep about 1/2 * 1/2 * 1/2 of points in each pass
+    Aabb<double> clipBox;
+    clipBox.set(1000.0, 2000.0, 300.0, 1100.0, 2100.0, 350.0);
+
+    EditorClassification classification;
+    classification.setEnabled(true);
+    for (size_t i = 0; i < classification.size(); i++)
+    {
+        classification.setEnabled(i, (i % 2) == 0);
+    }
+
+    Json in;
+    in["enabled"] = true;
+    for (size_t i = 0; i < 16; i++)
+    {
+        in["layers"][i]["id"] = i;
+        in["layers"][i]["enabled"] = (i < 8);
+    }
+    EditorLayers layers;
+    layers.read(in);
+
+    std::cout << "filter " << n << " points" << std::endl;
+
+    // Current path
+    std::vector<unsigned int> indicesScalar;
+    double best = 0;
+    for (size_t r = 0; r < BENCHMARK_REPEAT; r++)
+    {
+        double start = getRealTime();
+        filterScalar(indicesScalar, tile, clipBox, classification, layers);
+        best = bestTime(best, getRealTime() - start);
+    }
+    printRate("scalar", n, best);
+
+    // Fused path
+    EditorTileFilter tileFilter;
+    tileFilter.setClipBox(clipBox, tile.origin);
+    tileFilter.setClassification(classification);
+    tileFilter.setLayers(layers);
+
+    std::vector<uint64_t> visible;
+    best = 0;
+    for (size_t r = 0; r < BENCHMARK_REPEAT; r++)
+    {
+        double start = getRealTime();
+        tileFilter.apply(visible,
+                         tile.xyz.data(),
+                         tile.attrib.data(),
+                         tile.layer.data(),
+                         n);
+        best = bestTime(best, getRealTime() - start);
+    }
+    printRate("mask", n, best);
+
+    std::vector<unsigned int> indices;
+    best = 0;
+    for (size_t r = 0; r < BENCHMARK_REPEAT; r++)
+    {
+        double start = getRealTime();
+        tileFilter.apply(visible,
+                         tile.xyz.data(),
+                         tile.attrib.data(),
+                         tile.layer.data(),
+                         n);
+        EditorTileFilter::compact(indices, visible, n);
+        best = bestTime(best, getRealTime() - start);
+    }
+    printRate("mask+index", n, best);
+
+    // Incremental path, only classification has changed
+    std::vector<uint64_t> visibleFilter[3];
+    EditorTileFilter clipFilter;
+    clipFilter.setClipBox(clipBox, tile.origin);
+    clipFilter.apply(visibleFilter[0], tile.xyz.data(), nullptr, nullptr, n);
+    EditorTileFilter layerFilter;
+    layerFilter.setLayers(layers);
+    layerFilter.apply(visibleFilter[2], nullptr, nullptr, tile.layer.data(), n);
+
+    EditorTileFilter classFilter;
+    classFilter.setClassification(classification);
+    best = 0;
+    for (size_t r = 0; r < BENCHMARK_REPEAT; r++)
+    {
+        double start = getRealTime();
+        classFilter.apply(visibleFilter[1],
+                          nullptr,
+                          tile.attrib.data(),
+                          nullptr,
+                          n);
+        EditorTileFilter::combine(visible, visibleFilter, 3, n);
+        EditorTileFilter::compact(indices, visible, n);
+        best = bestTime(best, getRealTime() - start);
+    }
+    printRate("incremental", n, best);
+
+    std::cout << std::setw(12) << "selected" << std::setw(10)
+              << indices.size() << std::endl;
+
+    if (indices != indicesScalar)
+    {
+        THROW("Filtered points do not match");
+    }
+
+    // Layer identifiers from the project can be any 32-bit value
+    const uint32_t idLarge = 0xFFFFFFF0U;
+    Json inLarge;
+    inLarge["enabled"] = true;
+    for (size_t i = 0; i < 16; i++)
+    {
+        size_t id = (i % 2) ? i : idLarge + i;
+        inLarge["layers"][i]["id"] = id;
+        inLarge["layers"][i]["enabled"] = (i < 8);
+    }
+    EditorLayers layersLarge;
+    layersLarge.read(inLarge);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        if ((tile.layer[i] % 2) == 0)
+        {
+            tile.layer[i] += idLarge;
+        }
+    }
+
+    filterScalar(indicesScalar, tile, clipBox, classification, layersLarge);
+
+    tileFilter.setLayers(layersLarge);
+    tileFilter.apply(visible,
+                     tile.xyz.data(),
+                     tile.attrib.data(),
+                     tile.layer.data(),
+                     n);
+    EditorTileFilter::compact(indices, visible, n);
+
+    std::cout << std::setw(12) << "large ids" << std::setw(10)
+              << indices.size() << std::endl;
+
+    if (indices != indicesScalar)
+    {
+        THROW("Filtered points with large layer identifiers do not match");
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int command = COMMAND_NONE;
+    size_t nPoints = 1000000;
+    const char *inputPath = nullptr;
+
+    // Parse command line arguments
+    for (int opt = 1; opt < argc; opt++)
+    {
+        // Command
+        if (strcmp(argv[opt], "-d") == 0)
+        {
+            command = COMMAND_DECODE;
+        }
+        else if (strcmp(argv[opt], "-e") == 0)
+        {
+            command = COMMAND_ENCODE;
+        }
+        else if (strcmp(argv[opt], "-z") == 0)
+        {
+            command = COMMAND_COMPRESS;
+        }
+        else if (strcmp(argv[opt], "-m") == 0)
+        {
+            command = COMMAND_MEMORY;
+        }
+        else if (strcmp(argv[opt], "-f") == 0)
+        {
+            command = COMMAND_FILTER;
+        }
+        else if (strcmp(argv[opt], "-s") == 0)
+        {
+            command = COMMAND_SCAN;
+        }
+        else if (strcmp(argv[opt], "-l") == 0)
+        {
+            command = COMMAND_LOAD;
+        }
+        else if (strcmp(argv[opt], "-p") == 0)
+        {
+            command = COMMAND_PREFETCH;
+        }
+        else if (strcmp(argv[opt], "-o") == 0)
+        {
+            command = COMMAND_LOD;
+        }
+        else if (strcmp(argv[opt], "-r") == 0)
+        {
+            command = COMMAND_SCHEDULE;
+        }
+        else if (strcmp(argv[opt], "-t") == 0)
+        {
+            command = COMMAND_STRESS;
+        }
+
+        // Number of points
+        else if (strcmp(argv[opt], "-n") == 0)
+        {
+            getarg(&nPoints, opt, argc, argv);
+        }
+
+        // Input filename
+        else if (strcmp(argv[opt], "-i") == 0)
+        {
+            getarg(&inputPath, opt, argc, argv);
+        }
+    }
+
+    // Execute command
+    try
+    {
+        if (nPoints < 1)
+        {
+            THROW("Invalid number of points");
+        }
+
+        switch (command)
+        {
+            case COMMAND_DECODE:
+                cmd_decode(nPoints);
+                break;
+            case COMMAND_ENCODE:
+                cmd_encode(nPoints);
+                break;
+            case COMMAND_COMPRESS:
+                cmd_compress(inputPath, nPoints);
+                break;
+            case COMMAND_MEMORY:
+                cmd_memory(inputPath);
+                break;
+            case COMMAND_FILTER:
+                cmd_filter(nPoints);
+                break;
+            case COMMAND_SCAN:
+                cmd_scan(nPoints);
+                break;
+            case COMMAND_LOAD:
+                cmd_load(nPoints);
+                break;
+            case COMMAND_PREFETCH:
+                cmd_prefetch(nPoints);
+                break;
+            case COMMAND_LOD:
+                cmd_lod(nPoints);
+                break;
+            case COMMAND_SCHEDULE:
+                cmd_schedule(nPoints);
+                break;
+            case COMMAND_STRESS:
+                cmd_stress(nPoints);
+                break;
+            case COMMAND_NONE:
+            default:
+                THROW("Unknown command");
+                break;
+        }
+    }
+    catch (std::exception &e)
+    {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
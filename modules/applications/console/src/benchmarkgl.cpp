@@ -0,0 +1,1223 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file benchmarkgl.cpp */
+
+#define GL_GLEXT_PROTOTYPES
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <EditorBase.hpp>
+#include <EditorTile.hpp>
+#include <Error.hpp>
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <Json.hpp>
+#include <Matrix4.hpp>
+#include <Time.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define BENCHMARK_WIDTH 1024
+#define BENCHMARK_HEIGHT 768
+#define BENCHMARK_MAX_DIFFERENT_PIXELS 1.0
+#define BENCHMARK_FRAME_BUDGET 0.016
+
+enum Command
+{
+    COMMAND_NONE,
+    COMMAND_BUFFERS,
+    COMMAND_QUANTIZED,
+    COMMAND_PROJECT
+};
+
+void getarg(size_t *v, int &opt, int argc, char *argv[])
+{
+    opt++;
+    if (opt < argc)
+    {
+        *v = std::stoul(argv[opt]);
+    }
+}
+
+void getarg(const char **v, int &opt, int argc, char *argv[])
+{
+    opt++;
+    if (opt < argc)
+    {
+        *v = argv[opt];
+    }
+}
+
+/** Offscreen OpenGL context without a display.
+    Mesa software rendering (llvmpipe) is used when there is no GPU.
+*/
+class Context
+{
+public:
+    Context()
+        : display_(EGL_NO_DISPLAY),
+          surface_(EGL_NO_SURFACE),
+          context_(EGL_NO_CONTEXT)
+    {
+        // Surfaceless platform of Mesa does not need a window system
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+            reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+                eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (getPlatformDisplay)
+        {
+            display_ = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA,
+                                          EGL_DEFAULT_DISPLAY,
+                                          nullptr);
+        }
+        if (display_ == EGL_NO_DISPLAY)
+        {
+            display_ = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        }
+
+        EGLint major;
+        EGLint minor;
+        if (!eglInitialize(display_, &major, &minor))
+        {
+            THROW("Can't initialize EGL display");
+        }
+
+        const EGLint configAttributes[] = {EGL_SURFACE_TYPE,
+                                           EGL_PBUFFER_BIT,
+                                           EGL_RENDERABLE_TYPE,
+                                           EGL_OPENGL_BIT,
+                                           EGL_RED_SIZE,
+                                           8,
+                                           EGL_GREEN_SIZE,
+                                           8,
+                                           EGL_BLUE_SIZE,
+                                           8,
+                                           EGL_DEPTH_SIZE,
+                                           24,
+                                           EGL_NONE};
+        EGLConfig config;
+        EGLint n = 0;
+        if (!eglChooseConfig(display_, configAttributes, &config, 1, &n) ||
+            n == 0)
+        {
+            THROW("Can't find EGL configuration");
+        }
+
+        const EGLint surfaceAttributes[] = {EGL_WIDTH,
+                                            BENCHMARK_WIDTH,
+                                            EGL_HEIGHT,
+                                            BENCHMARK_HEIGHT,
+                                            EGL_NONE};
+        surface_ = eglCreatePbufferSurface(display_, config, surfaceAttributes);
+        if (surface_ == EGL_NO_SURFACE)
+        {
+            THROW("Can't create EGL surface");
+        }
+
+        // Compatibility profile for fixed function pipeline of the viewer
+        eglBindAPI(EGL_OPENGL_API);
+        context_ = eglCreateContext(display_, config, EGL_NO_CONTEXT, nullptr);
+        if (context_ == EGL_NO_CONTEXT)
+        {
+            THROW("Can't create OpenGL context");
+        }
+
+        if (!eglMakeCurrent(display_, surface_, surface_, context_))
+        {
+            THROW("Can't make OpenGL context current");
+        }
+    }
+
+    ~Context()
+    {
+        eglMakeCurrent(display_,
+                       EGL_NO_SURFACE,
+                       EGL_NO_SURFACE,
+                       EGL_NO_CONTEXT);
+        eglDestroyContext(display_, context_);
+        eglDestroySurface(display_, surface_);
+        eglTerminate(display_);
+    }
+
+protected:
+    EGLDisplay display_;
+    EGLSurface surface_;
+    EGLContext context_;
+};
+
+/** Tile with points like the viewer draws them.
+    Points are relative to the tile origin in float and quantized formats.
+*/
+struct Tile
+{
+    Vector3<double> origin;
+    std::vector<float> xyz;
+    std::vector<float> rgb;
+    std::vector<unsigned int> indices;
+
+    // Quantized format of the viewer
+    std::vector<int16_t> renderXyz;
+    Vector3<double> renderOrigin;
+    Vector3<double> renderScale;
+    std::vector<uint8_t> rgba;
+
+    GLuint xyzBuffer;
+    GLuint rgbBuffer;
+    GLuint indicesBuffer;
+};
+
+/** Create tiles on a regular grid with pseudo-random points. */
+void createTiles(std::vector<Tile> &tiles, size_t n, size_t tileSize)
+{
+    size_t nTiles = (n + tileSize - 1) / tileSize;
+    size_t nTilesX = 1;
+    while (nTilesX * nTilesX < nTiles)
+    {
+        nTilesX++;
+    }
+
+    std::srand(1);
+
+    tiles.resize(nTiles);
+    for (size_t i = 0; i < nTiles; i++)
+    {
+        Tile &tile = tiles[i];
+        size_t size = (i + 1 < nTiles) ? tileSize : n - i * tileSize;
+        const float r = static_cast<float>(RAND_MAX);
+
+        tile.origin.set(static_cast<double>(i % nTilesX),
+                        static_cast<double>(i / nTilesX),
+                        0.0);
+        tile.xyz.resize(size * 3);
+        tile.rgb.resize(size * 3);
+        tile.indices.resize(size);
+        for (size_t j = 0; j < size * 3; j++)
+        {
+            tile.xyz[j] = static_cast<float>(std::rand()) / r;
+            tile.rgb[j] = static_cast<float>(std::rand()) / r;
+        }
+        for (size_t j = 0; j < size; j++)
+        {
+            tile.indices[j] = static_cast<unsigned int>(j);
+        }
+
+        // Same conversion as the tile loader
+        EditorTile editorTile;
+        editorTile.origin = tile.origin;
+        editorTile.boundary.set(tile.origin[0],
+                                tile.origin[1],
+                                tile.origin[2],
+                                tile.origin[0] + 1.0,
+                                tile.origin[1] + 1.0,
+                                tile.origin[2] + 1.0);
+        editorTile.quantize(tile.xyz);
+        tile.renderXyz.swap(editorTile.renderXyz);
+        tile.renderOrigin = editorTile.renderOrigin;
+        tile.renderScale = editorTile.renderScale;
+
+        EditorTile::View view;
+        view.rgba.resize(size * 4);
+        for (size_t j = 0; j < size; j++)
+        {
+            view.setColor(j,
+                          tile.rgb[j * 3 + 0],
+                          tile.rgb[j * 3 + 1],
+                          tile.rgb[j * 3 + 2]);
+        }
+        tile.rgba.swap(view.rgba);
+
+        tile.xyzBuffer = 0;
+        tile.rgbBuffer = 0;
+        tile.indicesBuffer = 0;
+    }
+
+    // All tiles are in view
+    glViewport(0, 0, BENCHMARK_WIDTH, BENCHMARK_HEIGHT);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    double size = static_cast<double>(nTilesX);
+    glOrtho(0.0, size, 0.0, size, -1.0, 2.0);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+}
+
+/** Model transform of a tile like in the viewer. */
+void transform(const Tile &tile, bool quantized)
+{
+    Vector3<double> t = tile.origin;
+    glLoadIdentity();
+
+    if (quantized)
+    {
+        t = t + tile.renderOrigin;
+        glTranslated(t[0], t[1], t[2]);
+        glScaled(tile.renderScale[0],
+                 tile.renderScale[1],
+                 tile.renderScale[2]);
+    }
+    else
+    {
+        glTranslated(t[0], t[1], t[2]);
+    }
+}
+
+/** Client side arrays, all points are sent to OpenGL in each frame. */
+void renderArrays(const std::vector<Tile> &tiles)
+{
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+
+    for (const auto &tile : tiles)
+    {
+        transform(tile, false);
+        glVertexPointer(3, GL_FLOAT, 0, tile.xyz.data());
+        glColorPointer(3, GL_FLOAT, 0, tile.rgb.data());
+        glDrawElements(GL_POINTS,
+                       static_cast<GLsizei>(tile.indices.size()),
+                       GL_UNSIGNED_INT,
+                       tile.indices.data());
+    }
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_COLOR_ARRAY);
+}
+
+/** Bytes per point of vertex buffers. */
+size_t pointSize(bool quantized)
+{
+    if (quantized)
+    {
+        return 3 * sizeof(int16_t) + 4 * sizeof(uint8_t);
+    }
+
+    return 3 * sizeof(float) + 3 * sizeof(float);
+}
+
+/** Upload colors and point indices after filters changed. */
+void updateBuffers(Tile &tile, bool quantized)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, tile.rgbBuffer);
+    if (quantized)
+    {
+        glBufferSubData(GL_ARRAY_BUFFER,
+                        0,
+                        static_cast<GLsizeiptr>(tile.rgba.size()),
+                        tile.rgba.data());
+    }
+    else
+    {
+        glBufferSubData(
+            GL_ARRAY_BUFFER,
+            0,
+            static_cast<GLsizeiptr>(tile.rgb.size() * sizeof(float)),
+            tile.rgb.data());
+    }
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, tile.indicesBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                 static_cast<GLsizeiptr>(tile.indices.size() *
+                                         sizeof(unsigned int)),
+                 tile.indices.data(),
+                 GL_DYNAMIC_DRAW);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+/** Upload points once, when the tile becomes ready. */
+void createBuffers(Tile &tile, bool quantized)
+{
+    glGenBuffers(1, &tile.xyzBuffer);
+    glGenBuffers(1, &tile.rgbBuffer);
+    glGenBuffers(1, &tile.indicesBuffer);
+
+    size_t n = tile.indices.size();
+
+    glBindBuffer(GL_ARRAY_BUFFER, tile.xyzBuffer);
+    if (quantized)
+    {
+        glBufferData(GL_ARRAY_BUFFER,
+                     static_cast<GLsizeiptr>(n * 3 * sizeof(int16_t)),
+                     tile.renderXyz.data(),
+                     GL_STATIC_DRAW);
+    }
+    else
+    {
+        glBufferData(GL_ARRAY_BUFFER,
+                     static_cast<GLsizeiptr>(n * 3 * sizeof(float)),
+                     tile.xyz.data(),
+                     GL_STATIC_DRAW);
+    }
+
+    size_t colorSize = quantized ? n * 4 : n * 3 * sizeof(float);
+    glBindBuffer(GL_ARRAY_BUFFER, tile.rgbBuffer);
+    glBufferData(GL_ARRAY_BUFFER,
+                 static_cast<GLsizeiptr>(colorSize),
+                 nullptr,
+                 GL_DYNAMIC_DRAW);
+
+    updateBuffers(tile, quantized);
+}
+
+/** Release buffers on cache eviction. */
+void destroyBuffers(Tile &tile)
+{
+    glDeleteBuffers(1, &tile.xyzBuffer);
+    glDeleteBuffers(1, &tile.rgbBuffer);
+    glDeleteBuffers(1, &tile.indicesBuffer);
+}
+
+/** Vertex buffers, points are drawn from OpenGL memory. */
+void renderBuffers(const std::vector<Tile> &tiles, bool quantized)
+{
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+
+    for (const auto &tile : tiles)
+    {
+        transform(tile, quantized);
+
+        glBindBuffer(GL_ARRAY_BUFFER, tile.xyzBuffer);
+        if (quantized)
+        {
+            glVertexPointer(3, GL_SHORT, 0, nullptr);
+        }
+        else
+        {
+            glVertexPointer(3, GL_FLOAT, 0, nullptr);
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, tile.rgbBuffer);
+        if (quantized)
+        {
+            glColorPointer(4, GL_UNSIGNED_BYTE, 0, nullptr);
+        }
+        else
+        {
+            glColorPointer(3, GL_FLOAT, 0, nullptr);
+        }
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, tile.indicesBuffer);
+        glDrawElements(GL_POINTS,
+                       static_cast<GLsizei>(tile.indices.size()),
+                       GL_UNSIGNED_INT,
+                       nullptr);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_COLOR_ARRAY);
+}
+
+/** Time a frame until it is finished. */
+template <class Render> double frame(Render render)
+{
+    double start = getRealTime();
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    render();
+    glFinish();
+    return getRealTime() - start;
+}
+
+void print(const char *name, const std::vector<double> &times)
+{
+    double total = 0;
+    double min = times.empty() ? 0 : times[0];
+    for (const auto &it : times)
+    {
+        total += it;
+        if (it < min)
+        {
+            min = it;
+        }
+    }
+
+    double avg = times.empty() ? 0 : total / static_cast<double>(times.size());
+
+    std::cout << std::setw(16) << name << " avg " << avg * 1000.0
+              << " ms, min " << min * 1000.0 << " ms" << std::endl;
+}
+
+void checkError()
+{
+    if (glGetError() != GL_NO_ERROR)
+    {
+        THROW("OpenGL error");
+    }
+}
+
+void cmd_buffers(size_t n, size_t tileSize, size_t nFrames)
+{
+    Context context;
+
+    std::cout << glGetString(GL_RENDERER) << ", OpenGL "
+              << glGetString(GL_VERSION) << std::endl;
+
+    std::vector<Tile> tiles;
+    createTiles(tiles, n, tileSize);
+
+    std::cout << n << " points, " << tiles.size() << " tiles, "
+              << BENCHMARK_WIDTH << "x" << BENCHMARK_HEIGHT << ", "
+              << nFrames << " frames" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+
+    std::vector<double> times;
+
+    // Previous viewer, client side arrays
+    for (size_t i = 0; i < nFrames; i++)
+    {
+        times.push_back(frame([&]() { renderArrays(tiles); }));
+    }
+    print("client arrays", times);
+
+    // Vertex buffers, first frame uploads all tiles
+    times.clear();
+    times.push_back(frame([&]() {
+        for (auto &tile : tiles)
+        {
+            createBuffers(tile, false);
+        }
+        renderBuffers(tiles, false);
+    }));
+    print("upload", times);
+
+    times.clear();
+    for (size_t i = 0; i < nFrames; i++)
+    {
+        times.push_back(frame([&]() { renderBuffers(tiles, false); }));
+    }
+    print("vertex buffers", times);
+
+    // Filter change, colors and indices are uploaded again
+    times.clear();
+    for (size_t i = 0; i < nFrames; i++)
+    {
+        times.push_back(frame([&]() {
+            for (auto &tile : tiles)
+            {
+                updateBuffers(tile, false);
+            }
+            renderBuffers(tiles, false);
+        }));
+    }
+    print("color update", times);
+
+    for (auto &tile : tiles)
+    {
+        destroyBuffers(tile);
+    }
+
+    checkError();
+}
+
+/** Render all tiles in the given format and read the image back. */
+void renderImage(std::vector<Tile> &tiles,
+                 bool quantized,
+                 size_t nFrames,
+                 std::vector<uint8_t> &image)
+{
+    for (auto &tile : tiles)
+    {
+        createBuffers(tile, quantized);
+    }
+
+    std::vector<double> times;
+    for (size_t i = 0; i < nFrames; i++)
+    {
+        times.push_back(frame([&]() { renderBuffers(tiles, quantized); }));
+    }
+    print(quantized ? "quantized" : "float", times);
+
+    image.resize(BENCHMARK_WIDTH * BENCHMARK_HEIGHT * 4);
+    glReadPixels(0,
+                 0,
+                 BENCHMARK_WIDTH,
+                 BENCHMARK_HEIGHT,
+                 GL_RGBA,
+                 GL_UNSIGNED_BYTE,
+                 image.data());
+
+    for (auto &tile : tiles)
+    {
+        destroyBuffers(tile);
+    }
+
+    checkError();
+}
+
+void cmd_quantized(size_t n, size_t tileSize, size_t nFrames)
+{
+    Context context;
+
+    std::cout << glGetString(GL_RENDERER) << ", OpenGL "
+              << glGetString(GL_VERSION) << std::endl;
+
+    std::vector<Tile> tiles;
+    createTiles(tiles, n, tileSize);
+
+    std::cout << n << " points, " << tiles.size() << " tiles, "
+              << BENCHMARK_WIDTH << "x" << BENCHMARK_HEIGHT << ", "
+              << nFrames << " frames" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+
+    // Frame time and memory of vertex data in both formats
+    std::vector<uint8_t> imageFloat;
+    std::vector<uint8_t> imageQuantized;
+    renderImage(tiles, false, nFrames, imageFloat);
+    renderImage(tiles, true, nFrames, imageQuantized);
+
+    double mb = 1.0 / (1024.0 * 1024.0);
+    std::cout << std::setw(16) << "memory" << " float "
+              << static_cast<double>(n * pointSize(false)) * mb
+              << " MiB, quantized "
+              << static_cast<double>(n * pointSize(true)) * mb
+              << " MiB, indices "
+              << static_cast<double>(n * sizeof(unsigned int)) * mb
+              << " MiB" << std::endl;
+
+    // Visual equivalence, colors may differ by rounding, a point may move
+    // to a neighboring pixel or change depth order with a close point
+    size_t nPixels = BENCHMARK_WIDTH * BENCHMARK_HEIGHT;
+    size_t nDifferent = 0;
+    int maxDifference = 0;
+    for (size_t i = 0; i < nPixels; i++)
+    {
+        int difference = 0;
+        for (size_t k = 0; k < 3; k++)
+        {
+            int a = imageFloat[i * 4 + k];
+            int b = imageQuantized[i * 4 + k];
+            difference = std::max(difference, std::abs(a - b));
+        }
+
+        maxDifference = std::max(maxDifference, difference);
+        if (difference > 1)
+        {
+            nDifferent++;
+        }
+    }
+
+    double percent =
+        100.0 * static_cast<double>(nDifferent) / static_cast<double>(nPixels);
+    std::cout << std::setw(16) << "equivalence" << " " << nDifferent
+              << " pixels differ (" << percent << " %), max difference "
+              << maxDifference << std::endl;
+
+    if (percent > BENCHMARK_MAX_DIFFERENT_PIXELS)
+    {
+        THROW("Quantized image is not equivalent");
+    }
+}
+
+/** Tile buffers of the viewer without Qt.
+    Quantized points are uploaded once per tile, colors and indices once
+    per published view. Buffers of evicted tiles are released.
+*/
+class TileBuffers
+{
+public:
+    TileBuffers() : bytes_(0) {}
+    ~TileBuffers() { clear(); }
+
+    void render(const std::shared_ptr<EditorTile> &tile,
+                const std::shared_ptr<const EditorTile::View> &view,
+                size_t begin,
+                size_t end)
+    {
+        Buffers &buffers = buffers_[tile.get()];
+        if (buffers.tile.lock() != tile)
+        {
+            destroy(buffers);
+            buffers.tile = tile;
+            create(buffers, tile->renderXyz);
+        }
+
+        if (buffers.view.lock() != view)
+        {
+            buffers.view = view;
+            update(buffers, *view);
+        }
+
+        end = std::min(end, view->indices.size());
+        if (begin >= end || buffers.xyz == 0)
+        {
+            return;
+        }
+
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glBindBuffer(GL_ARRAY_BUFFER, buffers.xyz);
+        glVertexPointer(3, GL_SHORT, 0, nullptr);
+
+        if (buffers.rgba != 0)
+        {
+            glEnableClientState(GL_COLOR_ARRAY);
+            glBindBuffer(GL_ARRAY_BUFFER, buffers.rgba);
+            glColorPointer(4, GL_UNSIGNED_BYTE, 0, nullptr);
+        }
+        else
+        {
+            glColor3f(1.0F, 1.0F, 1.0F);
+        }
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.indices);
+        glDrawElements(GL_POINTS,
+                       static_cast<GLsizei>(end - begin),
+                       GL_UNSIGNED_INT,
+                       reinterpret_cast<const void *>(begin * sizeof(GLuint)));
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glDisableClientState(GL_VERTEX_ARRAY);
+        glDisableClientState(GL_COLOR_ARRAY);
+    }
+
+    void release()
+    {
+        auto it = buffers_.begin();
+        while (it != buffers_.end())
+        {
+            if (it->second.tile.expired())
+            {
+                destroy(it->second);
+                it = buffers_.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void clear()
+    {
+        for (auto &it : buffers_)
+        {
+            destroy(it.second);
+        }
+        buffers_.clear();
+    }
+
+    size_t memorySize() const { return bytes_; }
+
+protected:
+    /** Buffers of one tile. */
+    struct Buffers
+    {
+        std::weak_ptr<EditorTile> tile;
+        std::weak_ptr<const EditorTile::View> view;
+        GLuint xyz{0};
+        GLuint rgba{0};
+        GLuint indices{0};
+        size_t xyzSize{0};
+        size_t rgbaSize{0};
+        size_t indicesSize{0};
+    };
+
+    std::unordered_map<const EditorTile *, Buffers> buffers_;
+    size_t bytes_;
+
+    void create(Buffers &buffers, const std::vector<int16_t> &xyz)
+    {
+        if (xyz.empty())
+        {
+            return;
+        }
+
+        buffers.xyzSize = xyz.size() * sizeof(int16_t);
+        glGenBuffers(1, &buffers.xyz);
+        glBindBuffer(GL_ARRAY_BUFFER, buffers.xyz);
+        glBufferData(GL_ARRAY_BUFFER,
+                     static_cast<GLsizeiptr>(buffers.xyzSize),
+                     xyz.data(),
+                     GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        bytes_ += buffers.xyzSize;
+    }
+
+    void update(Buffers &buffers, const EditorTile::View &view)
+    {
+        bytes_ -= buffers.rgbaSize + buffers.indicesSize;
+
+        if (!view.rgba.empty())
+        {
+            if (buffers.rgba == 0)
+            {
+                glGenBuffers(1, &buffers.rgba);
+            }
+            buffers.rgbaSize = view.rgba.size();
+            glBindBuffer(GL_ARRAY_BUFFER, buffers.rgba);
+            glBufferData(GL_ARRAY_BUFFER,
+                         static_cast<GLsizeiptr>(buffers.rgbaSize),
+                         view.rgba.data(),
+                         GL_DYNAMIC_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+
+        if (buffers.indices == 0)
+        {
+            glGenBuffers(1, &buffers.indices);
+        }
+        buffers.indicesSize = view.indices.size() * sizeof(unsigned int);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.indices);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                     static_cast<GLsizeiptr>(buffers.indicesSize),
+                     view.indices.data(),
+                     GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+        bytes_ += buffers.rgbaSize + buffers.indicesSize;
+    }
+
+    void destroy(Buffers &buffers)
+    {
+        bytes_ -= buffers.xyzSize + buffers.rgbaSize + buffers.indicesSize;
+
+        glDeleteBuffers(1, &buffers.xyz);
+        glDeleteBuffers(1, &buffers.rgba);
+        glDeleteBuffers(1, &buffers.indices);
+        buffers = Buffers();
+    }
+};
+
+/** Read a camera path, eye, center and up in view coordinates. */
+void readCameraPath(std::vector<Camera> &cameras, const std::string &path)
+{
+    Json in;
+    in.read(path);
+
+    if (!in.containsArray("cameras"))
+    {
+        THROW("Camera path has no cameras");
+    }
+
+    for (const auto &it : in["cameras"].array())
+    {
+        Camera camera;
+        camera.read(it);
+        cameras.push_back(camera);
+    }
+}
+
+/** Orbit around the data which zooms in from the whole view to detail. */
+void createCameraPath(std::vector<Camera> &cameras,
+                      const Aabb<double> &box,
+                      size_t n)
+{
+    Vector3<double> center = box.getCenter();
+    double radius = box.radius();
+
+    for (size_t i = 0; i < n; i++)
+    {
+        double t = (n > 1) ? static_cast<double>(i) / static_cast<double>(n - 1)
+                           : 0.0;
+        double angle = t * 2.0 * 3.1415927;
+        double distance = radius * (3.0 - 2.5 * t);
+
+        Camera camera;
+        camera.eye.set(center[0] + distance * std::cos(angle),
+                       center[1] + distance * std::sin(angle),
+                       center[2] + distance * 0.5);
+        camera.center.set(center[0], center[1], center[2]);
+        camera.up.set(0.0F, 0.0F, 1.0F);
+        cameras.push_back(camera);
+    }
+}
+
+/** Projection and view matrices of the viewer. */
+void setCamera(const Camera &camera)
+{
+    double width = static_cast<double>(camera.width);
+    double height = static_cast<double>(camera.height);
+    double aspect = width / height;
+    double distance =
+        static_cast<double>((camera.eye - camera.center).length());
+    double zNear = 0.01 * distance;
+    double zFar = 100000.0 * distance;
+
+    glViewport(0,
+               0,
+               static_cast<GLsizei>(camera.width),
+               static_cast<GLsizei>(camera.height));
+
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    if (camera.perspective)
+    {
+        double fov = static_cast<double>(camera.fov) * 3.1415927 / 180.0;
+        double top = zNear * std::tan(fov * 0.5);
+        glFrustum(-aspect * top, aspect * top, -top, top, zNear, zFar);
+    }
+    else
+    {
+        double top = 28.9 * 2.0 * zFar * zNear / (zFar - zNear);
+        glOrtho(-aspect * top, aspect * top, -top, top, -zFar, zFar);
+    }
+
+    Vector3<double> eye;
+    Vector3<double> center;
+    Vector3<double> up;
+    eye = camera.eye;
+    center = camera.center;
+    up = camera.up;
+
+    Matrix4<double> m;
+    m.lookAt(eye, center, up);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadMatrixd(m.data());
+}
+
+/** Draw tiles of the view which are not drawn yet, like the viewer.
+    Returns true when the whole view is drawn.
+*/
+bool paint(EditorBase &editor, TileBuffers &buffers, size_t &nPoints)
+{
+    std::shared_ptr<EditorCache::Snapshot> view = editor.tileViewSnapshot(0);
+    size_t tileViewSize = view->tiles.size();
+
+    buffers.release();
+
+    double t1 = getRealTime();
+
+    if (tileViewSize == 0)
+    {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    for (size_t tileIndex = 0; tileIndex < tileViewSize; tileIndex++)
+    {
+        const EditorTile &tile = *view->tiles[tileIndex];
+        EditorCache::Frame &frame = view->frames[tileIndex];
+        std::shared_ptr<const EditorTile::View> tileView = tile.snapshot();
+
+        if (tileView)
+        {
+            frame.setPointCount(tileView->indices.size());
+        }
+
+        if (tileView && !frame.isFinished())
+        {
+            if (tileIndex == 0 && frame.isStarted())
+            {
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            }
+
+            size_t begin;
+            size_t end;
+            frame.renderRange(begin, end);
+            if (begin < end)
+            {
+                const EditorDataSet &dataSet = editor.dataSet(tile.dataSetId);
+                Vector3<double> t =
+                    dataSet.translation + tile.origin + tile.renderOrigin;
+                const Vector3<double> &s = tile.renderScale;
+                glPushMatrix();
+                glTranslated(t[0], t[1], t[2]);
+                glScaled(s[0], s[1], s[2]);
+                buffers.render(view->tiles[tileIndex], tileView, begin, end);
+                glPopMatrix();
+                nPoints += end - begin;
+            }
+
+            frame.nextFrame();
+
+            if (getRealTime() - t1 > BENCHMARK_FRAME_BUDGET)
+            {
+                break;
+            }
+        }
+    }
+
+    glFinish();
+
+    for (size_t tileIndex = 0; tileIndex < tileViewSize; tileIndex++)
+    {
+        if (!view->frames[tileIndex].isFinished())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/** Fraction of pixels covered by points, from the depth buffer. */
+double imageCoverage(std::vector<float> &depth)
+{
+    size_t nPixels = BENCHMARK_WIDTH * BENCHMARK_HEIGHT;
+    depth.resize(nPixels);
+    glReadPixels(0,
+                 0,
+                 BENCHMARK_WIDTH,
+                 BENCHMARK_HEIGHT,
+                 GL_DEPTH_COMPONENT,
+                 GL_FLOAT,
+                 depth.data());
+
+    size_t n = 0;
+    for (size_t i = 0; i < nPixels; i++)
+    {
+        if (depth[i] < 1.0F)
+        {
+            n++;
+        }
+    }
+
+    return static_cast<double>(n) / static_cast<double>(nPixels);
+}
+
+/** Replay a camera path over a project and report each frame as JSON.
+    A frame is a camera update drawn in passes until the view is complete,
+    tiles are loaded in the render loop, so the result is reproducible.
+*/
+void cmd_project(const char *projectPath,
+                 const char *cameraPath,
+                 const char *outputPath,
+                 size_t nFrames)
+{
+    Context context;
+
+    EditorBase editor;
+    editor.open(projectPath);
+    editor.setNumberOfLoaderThreads(0);
+
+    std::vector<Camera> cameras;
+    if (cameraPath)
+    {
+        readCameraPath(cameras, cameraPath);
+    }
+    else
+    {
+        createCameraPath(cameras, editor.boundaryView(), nFrames);
+    }
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+
+    TileBuffers buffers;
+    std::vector<float> depth;
+
+    Json out;
+    out["renderer"] = reinterpret_cast<const char *>(glGetString(GL_RENDERER));
+    out["project"] = projectPath;
+    out["width"] = BENCHMARK_WIDTH;
+    out["height"] = BENCHMARK_HEIGHT;
+    out["pointBudget"] = editor.settings().view().pointBudget();
+
+    double timeTotal = 0;
+    double timeMax = 0;
+    size_t pointsTotal = 0;
+    size_t hitsTotal = 0;
+    size_t missesTotal = 0;
+
+    for (size_t i = 0; i < cameras.size(); i++)
+    {
+        Camera &camera = cameras[i];
+        camera.width = BENCHMARK_WIDTH;
+        camera.height = BENCHMARK_HEIGHT;
+
+        EditorTileStore::Statistics before = editor.tileStore().statistics();
+
+        double start = getRealTime();
+        double firstPass = 0;
+        size_t nPasses = 0;
+        size_t nPoints = 0;
+
+        setCamera(camera);
+        editor.updateCamera(0, camera);
+
+        // Render loop of the viewer, one tile is loaded per pass
+        while (true)
+        {
+            bool loaded = editor.loadView();
+            bool drawn = paint(editor, buffers, nPoints);
+
+            nPasses++;
+            if (nPasses == 1)
+            {
+                firstPass = getRealTime() - start;
+            }
+
+            if (loaded && drawn)
+            {
+                break;
+            }
+        }
+
+        double time = getRealTime() - start;
+        double coverage = imageCoverage(depth);
+        timeTotal += time;
+        timeMax = std::max(timeMax, time);
+        pointsTotal += nPoints;
+
+        // Tiles of the view which were resident are cache hits
+        const EditorTileStore::Statistics &stats =
+            editor.tileStore().statistics();
+        size_t nTiles = editor.tileViewSize(0);
+        size_t misses = static_cast<size_t>(stats.misses - before.misses);
+        size_t hits = (nTiles > misses) ? nTiles - misses : 0;
+        hitsTotal += hits;
+        missesTotal += misses;
+        double hitRate = (nTiles > 0) ? static_cast<double>(hits) /
+                                            static_cast<double>(nTiles)
+                                      : 1.0;
+
+        Json &frame = out["frames"][i];
+        frame["time"] = time * 1000.0;
+        frame["firstPass"] = firstPass * 1000.0;
+        frame["passes"] = nPasses;
+        frame["points"] = nPoints;
+        frame["coverage"] = coverage;
+        frame["tiles"] = nTiles;
+        frame["tilesLoaded"] = misses;
+        frame["cacheHits"] = hits;
+        frame["cacheHitRate"] = hitRate;
+        frame["residentBytes"] = stats.residentBytes;
+        frame["bufferBytes"] = buffers.memorySize();
+    }
+
+    checkError();
+
+    double nCameras = static_cast<double>(cameras.size());
+    Json &summary = out["summary"];
+    summary["frames"] = cameras.size();
+    summary["timeAverage"] = (nCameras > 0) ? timeTotal * 1000.0 / nCameras : 0;
+    summary["timeMax"] = timeMax * 1000.0;
+    summary["points"] = pointsTotal;
+    summary["tilesLoaded"] = missesTotal;
+    summary["cacheHitRate"] =
+        (hitsTotal + missesTotal > 0)
+            ? static_cast<double>(hitsTotal) /
+                  static_cast<double>(hitsTotal + missesTotal)
+            : 1.0;
+
+    if (outputPath)
+    {
+        out.write(outputPath);
+    }
+    else
+    {
+        std::cout << out.serialize() << std::endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int command = COMMAND_NONE;
+    size_t nPoints = 50000000;
+    size_t tileSize = 100000;
+    size_t nFrames = 5;
+    const char *projectPath = nullptr;
+    const char *cameraPath = nullptr;
+    const char *outputPath = nullptr;
+
+    // Parse command line arguments
+    for (int opt = 1; opt < argc; opt++)
+    {
+        // Command
+        if (strcmp(argv[opt], "-b") == 0)
+        {
+            command = COMMAND_BUFFERS;
+        }
+        else if (strcmp(argv[opt], "-q") == 0)
+        {
+            command = COMMAND_QUANTIZED;
+        }
+        else if (strcmp(argv[opt], "-p") == 0)
+        {
+            command = COMMAND_PROJECT;
+            getarg(&projectPath, opt, argc, argv);
+        }
+
+        // Camera path
+        else if (strcmp(argv[opt], "-c") == 0)
+        {
+            getarg(&cameraPath, opt, argc, argv);
+        }
+
+        // Report path
+        else if (strcmp(argv[opt], "-o") == 0)
+        {
+            getarg(&outputPath, opt, argc, argv);
+        }
+
+        // Number of points
+        else if (strcmp(argv[opt], "-n") == 0)
+        {
+            getarg(&nPoints, opt, argc, argv);
+        }
+
+        // Number of points in a tile
+        else if (strcmp(argv[opt], "-t") == 0)
+        {
+            getarg(&tileSize, opt, argc, argv);
+        }
+
+        // Number of frames
+        else if (strcmp(argv[opt], "-f") == 0)
+        {
+            getarg(&nFrames, opt, argc, argv);
+        }
+    }
+
+    // Execute command
+    try
+    {
+        if (nPoints < 1 || tileSize < 1)
+        {
+            THROW("Invalid number of points");
+        }
+
+        switch (command)
+        {
+            case COMMAND_BUFFERS:
+                cmd_buffers(nPoints, tileSize, nFrames);
+                break;
+            case COMMAND_QUANTIZED:
+                cmd_quantized(nPoints, tileSize, nFrames);
+                break;
+            case COMMAND_PROJECT:
+                cmd_project(projectPath, cameraPath, outputPath, nFrames);
+                break;
+            case COMMAND_NONE:
+            default:
+                THROW("Unknown command");
+                break;
+        }
+    }
+    catch (std::exception &e)
+    {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -21,16 +21,20 @@
 
 #include <Aabb.hpp>
 #include <Error.hpp>
+#include <FileColumns.hpp>
 #include <FileIndexBuilder.hpp>
 #include <FileLas.hpp>
+#include <FileLasCompression.hpp>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <vector>
 
 enum Command
 {
     COMMAND_NONE,
     COMMAND_CREATE_INDEX,
+    COMMAND_CREATE_COLUMNS,
     COMMAND_PRINT,
     COMMAND_SELECT
 };
@@ -88,6 +92,16 @@ void cmd_create_index(const char *outputPath,
     FileIndexBuilder::index(outputPath, inputPath, settings);
 }
 
+void cmd_create_columns(const char *inputPath)
+{
+    if (!inputPath)
+    {
+        THROW("Missing input file path argument");
+    }
+
+    FileColumns::create(inputPath);
+}
+
 void cmd_print(const char *inputPath, uint64_t nPointsMax)
 {
     if (!inputPath)
@@ -110,14 +124,42 @@ void cmd_print(const char *inputPath, uint64_t nPointsMax)
     {
         nPoints = nPointsMax;
     }
-    for (uint64_t i = 0; i < nPoints; i++)
+
+    const std::string pathIndex = FileIndexBuilder::extension(inputPath);
+    if (las.header.point_data_compressed)
     {
-        las.readPoint(pt);
-        std::cout << pt << std::endl;
+        // Compressed points are decompressed by nodes in file order
+        FileIndex index;
+        index.read(pathIndex);
+        size_t size = las.header.point_data_record_length;
+        std::vector<uint8_t> buffer;
+
+        for (size_t i = 0; i < index.size() && nPoints > 0; i++)
+        {
+            const FileIndex::Node *node = index.at(i);
+            buffer.resize(static_cast<size_t>(node->size) * size);
+            FileLasCompression::readNode(buffer.data(), las, pathIndex, *node);
+
+            for (uint64_t j = 0; j < node->size && nPoints > 0; j++)
+            {
+                las.readPoint(pt,
+                              buffer.data() + (j * size),
+                              las.header.point_data_record_format);
+                std::cout << pt << std::endl;
+                nPoints--;
+            }
+        }
+    }
+    else
+    {
+        for (uint64_t i = 0; i < nPoints; i++)
+        {
+            las.readPoint(pt);
+            std::cout << pt << std::endl;
+        }
     }
 
     // Index
-    const std::string pathIndex = FileIndexBuilder::extension(inputPath);
     if (File::exists(pathIndex))
     {
         FileIndex indexL1;
@@ -164,6 +206,10 @@ int main(int argc, char *argv[])
         {
             command = COMMAND_CREATE_INDEX;
         }
+        else if (strcmp(argv[opt], "-k") == 0)
+        {
+            command = COMMAND_CREATE_COLUMNS;
+        }
         else if (strcmp(argv[opt], "-p") == 0)
         {
             command = COMMAND_PRINT;
@@ -196,6 +242,10 @@ int main(int argc, char *argv[])
         {
             getarg(&settings.maxLevel2, opt, argc, argv);
         }
+        else if (strcmp(argv[opt], "-z") == 0)
+        {
+            settings.compressed = true;
+        }
 
         // Input/Output filenames
         else if (strcmp(argv[opt], "-i") == 0)
@@ -242,6 +292,9 @@ int main(int argc, char *argv[])
             case COMMAND_CREATE_INDEX:
                 cmd_create_index(outputPath, inputPath, settings);
                 break;
+            case COMMAND_CREATE_COLUMNS:
+                cmd_create_columns(inputPath);
+                break;
             case COMMAND_PRINT:
                 cmd_print(inputPath, nPointsMax);
                 break;
@@ -0,0 +1,203 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file render.cpp */
+
+#include <EditorBase.hpp>
+#include <EditorRasterizer.hpp>
+#include <Error.hpp>
+#include <FileBmp.hpp>
+#include <Time.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+void getarg(size_t *v, int &opt, int argc, char *argv[])
+{
+    opt++;
+    if (opt < argc)
+    {
+        *v = std::stoul(argv[opt]);
+    }
+}
+
+void getarg(float *v, int &opt, int argc, char *argv[])
+{
+    opt++;
+    if (opt < argc)
+    {
+        *v = std::stof(argv[opt]);
+    }
+}
+
+void getarg(const char **v, int &opt, int argc, char *argv[])
+{
+    opt++;
+    if (opt < argc)
+    {
+        *v = argv[opt];
+    }
+}
+
+/** Render a project into a BMP image without a display. */
+void cmd_render(const char *outputPath,
+                const char *inputPath,
+                const char *cameraPath,
+                size_t width,
+                size_t height,
+                float pointSize,
+                size_t nThreads,
+                size_t memory)
+{
+    if (!inputPath || !outputPath)
+    {
+        THROW("Missing input or output path");
+    }
+
+    EditorBase editor;
+    editor.open(inputPath);
+
+    if (pointSize > 0.0F)
+    {
+        EditorSettings::View view = editor.settings().view();
+        view.setPointSize(pointSize);
+        editor.setSettingsView(view);
+    }
+
+    // Camera of the viewer or an overview from the top
+    Camera camera;
+    if (cameraPath)
+    {
+        Json in;
+        in.read(cameraPath);
+        camera.read(in);
+        camera.width = width;
+        camera.height = height;
+    }
+    else
+    {
+        const Aabb<double> &box = editor.boundaryView();
+        camera = EditorRasterizer::overview(box, width, height);
+    }
+
+    FileBmp image;
+    image.create(outputPath, width, height);
+
+    EditorRasterizer rasterizer;
+    if (nThreads > 0)
+    {
+        rasterizer.setNumberOfThreads(nThreads);
+    }
+    rasterizer.setMemoryBudget(memory * 1024 * 1024);
+
+    double start = getRealTime();
+
+    rasterizer.render(&editor,
+                      camera,
+                      [&image](const uint8_t *rgb, size_t y, size_t rows)
+                      { image.write(rgb, y, rows); });
+
+    image.close();
+
+    double seconds = getRealTime() - start;
+    const EditorRasterizer::Statistics &stats = rasterizer.statistics();
+    std::cout << width << "x" << height << " in " << stats.bands
+              << " bands, " << stats.tiles << " tiles, " << stats.points
+              << " points, " << seconds << " s" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *outputPath = nullptr;
+    const char *inputPath = nullptr;
+    const char *cameraPath = nullptr;
+    size_t width = 4096;
+    size_t height = 4096;
+    float pointSize = 0.0F;
+    size_t nThreads = 0;
+    size_t memory = 256;
+
+    // Parse command line arguments
+    for (int opt = 1; opt < argc; opt++)
+    {
+        // Input/Output filenames
+        if (strcmp(argv[opt], "-i") == 0)
+        {
+            getarg(&inputPath, opt, argc, argv);
+        }
+        else if (strcmp(argv[opt], "-o") == 0)
+        {
+            getarg(&outputPath, opt, argc, argv);
+        }
+
+        // Camera in JSON
+        else if (strcmp(argv[opt], "-c") == 0)
+        {
+            getarg(&cameraPath, opt, argc, argv);
+        }
+
+        // Image size in pixels
+        else if (strcmp(argv[opt], "-x") == 0)
+        {
+            getarg(&width, opt, argc, argv);
+        }
+        else if (strcmp(argv[opt], "-y") == 0)
+        {
+            getarg(&height, opt, argc, argv);
+        }
+
+        // Point size in pixels
+        else if (strcmp(argv[opt], "-p") == 0)
+        {
+            getarg(&pointSize, opt, argc, argv);
+        }
+
+        // Number of threads
+        else if (strcmp(argv[opt], "-t") == 0)
+        {
+            getarg(&nThreads, opt, argc, argv);
+        }
+
+        // Memory for image rows in MB
+        else if (strcmp(argv[opt], "-m") == 0)
+        {
+            getarg(&memory, opt, argc, argv);
+        }
+    }
+
+    // Execute command
+    try
+    {
+        cmd_render(outputPath,
+                   inputPath,
+                   cameraPath,
+                   width,
+                   height,
+                   pointSize,
+                   nThreads,
+                   memory);
+    }
+    catch (std::exception &e)
+    {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -97,6 +97,12 @@ inline uint32_t ltoh32(const uint8_t *src)
            (static_cast<uint32_t>(src[1]) << 8) | static_cast<uint32_t>(src[0]);
 }
 
+/** Convert little to host endian in 4 bytes of signed integer. */
+inline int32_t ltohs32(const uint8_t *src)
+{
+    return static_cast<int32_t>(ltoh32(src));
+}
+
 /** Convert network big to host endian in 4 bytes. */
 inline uint32_t ntoh32(const uint8_t *src)
 {
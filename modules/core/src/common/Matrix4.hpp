@@ -431,17 +431,17 @@ void Matrix4<T>::lookAt(const Vector3<T> &eye,
 
     Vector3<T> u = r.crossProduct(v);
 
-    T x = -eye(0);
-    T y = -eye(1);
-    T z = -eye(2);
+    T x = -eye[0];
+    T y = -eye[1];
+    T z = -eye[2];
 
-    data_[0][0] = r(0);
-    data_[1][0] = r(1);
-    data_[2][0] = r(2);
+    data_[0][0] = r[0];
+    data_[1][0] = r[1];
+    data_[2][0] = r[2];
     data_[3][0] = data_[0][0] * x + data_[1][0] * y + data_[2][0] * z;
-    data_[0][1] = u(0);
-    data_[1][1] = u(1);
-    data_[2][1] = u(2);
+    data_[0][1] = u[0];
+    data_[1][1] = u[1];
+    data_[2][1] = u[2];
     data_[3][1] = data_[0][1] * x + data_[1][1] * y + data_[2][1] * z;
     data_[0][2] = -v[0];
     data_[1][2] = -v[1];
@@ -63,6 +63,11 @@ public:
         return Vector3<T>(a[0] + b[0], a[1] + b[1], a[2] + b[2]);
     }
 
+    friend Vector3<T> operator-(const Vector3<T> &a)
+    {
+        return Vector3<T>(-a[0], -a[1], -a[2]);
+    }
+
     friend Vector3<T> operator-(const Vector3<T> &a, const Vector3<T> &b)
     {
         return Vector3<T>(a[0] - b[0], a[1] - b[1], a[2] - b[2]);
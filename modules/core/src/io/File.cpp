@@ -507,6 +507,32 @@ bool File::exists(const std::string &path)
     return ret == 0;
 }
 
+uint64_t File::fileSize(const std::string &path)
+{
+    struct stat st;
+
+    if (::stat(path.c_str(), &st) != 0)
+    {
+        THROW_ERRNO("Can't stat file '" + path + "'");
+    }
+
+    return static_cast<uint64_t>(st.st_size);
+}
+
+uint64_t File::fileModified(const std::string &path)
+{
+    struct stat st;
+
+    if (::stat(path.c_str(), &st) != 0)
+    {
+        THROW_ERRNO("Can't stat file '" + path + "'");
+    }
+
+    // Nanoseconds since the Epoch
+    return (static_cast<uint64_t>(st.st_mtim.tv_sec) * 1000000000ULL) +
+           static_cast<uint64_t>(st.st_mtim.tv_nsec);
+}
+
 bool File::isAbsolute(const std::string &path)
 {
     std::filesystem::path fsPath(path);
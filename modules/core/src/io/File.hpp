@@ -53,6 +53,8 @@ public:
 
     static std::string currentPath();
     static bool exists(const std::string &path);
+    static uint64_t fileSize(const std::string &path);
+    static uint64_t fileModified(const std::string &path);
     static bool isAbsolute(const std::string &path);
     static std::string fileName(const std::string &path);
     static std::string fileExtension(const std::string &path);
@@ -0,0 +1,100 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file FileBmp.cpp */
+
+#include <Endian.hpp>
+#include <Error.hpp>
+#include <FileBmp.hpp>
+
+#define FILE_BMP_HEADER_SIZE 54
+
+FileBmp::FileBmp() : width_(0), height_(0), stride_(0)
+{
+}
+
+FileBmp::~FileBmp()
+{
+}
+
+void FileBmp::create(const std::string &path, size_t width, size_t height)
+{
+    // Rows are padded to 4 bytes
+    size_t stride = (width * 3 + 3) & ~static_cast<size_t>(3);
+    uint64_t data = static_cast<uint64_t>(stride) * height;
+    uint64_t size = FILE_BMP_HEADER_SIZE + data;
+    if (width < 1 || height < 1 || width > 0x7fffffff ||
+        height > 0x7fffffff || size > 0xffffffff)
+    {
+        THROW("Invalid BMP image size");
+    }
+
+    file_.create(path);
+
+    width_ = width;
+    height_ = height;
+    stride_ = stride;
+    row_.resize(stride, 0);
+
+    // File header and BITMAPINFOHEADER
+    uint8_t buffer[FILE_BMP_HEADER_SIZE] = {};
+    buffer[0] = 'B';
+    buffer[1] = 'M';
+    htol32(&buffer[2], static_cast<uint32_t>(size));
+    htol32(&buffer[10], FILE_BMP_HEADER_SIZE);
+    htol32(&buffer[14], 40);
+    htol32(&buffer[18], static_cast<uint32_t>(width));
+    htol32(&buffer[22], static_cast<uint32_t>(height));
+    htol16(&buffer[26], 1);
+    htol16(&buffer[28], 24);
+    htol32(&buffer[34], static_cast<uint32_t>(data));
+    htol32(&buffer[38], 2835);
+    htol32(&buffer[42], 2835);
+
+    file_.write(buffer, FILE_BMP_HEADER_SIZE);
+}
+
+void FileBmp::write(const uint8_t *rgb, size_t y, size_t rows)
+{
+    if (y + rows > height_)
+    {
+        THROW("BMP rows are out of the image");
+    }
+
+    for (size_t r = 0; r < rows; r++)
+    {
+        // Bottom-up rows in BGR order
+        const uint8_t *src = rgb + r * width_ * 3;
+        for (size_t x = 0; x < width_; x++)
+        {
+            row_[x * 3 + 0] = src[x * 3 + 2];
+            row_[x * 3 + 1] = src[x * 3 + 1];
+            row_[x * 3 + 2] = src[x * 3 + 0];
+        }
+
+        uint64_t row = height_ - 1 - y - r;
+        file_.seek(FILE_BMP_HEADER_SIZE + row * stride_);
+        file_.write(row_.data(), stride_);
+    }
+}
+
+void FileBmp::close()
+{
+    file_.close();
+}
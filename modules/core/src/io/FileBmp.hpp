@@ -0,0 +1,54 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file FileBmp.hpp */
+
+#ifndef FILE_BMP_HPP
+#define FILE_BMP_HPP
+
+#include <File.hpp>
+#include <string>
+#include <vector>
+
+/** BMP (Bitmap) File Format.
+    Writes 24-bit RGB images by rows, so images larger than memory can be
+    created in parts. Rows are given from top to bottom in any order.
+*/
+class FileBmp
+{
+public:
+    FileBmp();
+    ~FileBmp();
+
+    void create(const std::string &path, size_t width, size_t height);
+    void write(const uint8_t *rgb, size_t y, size_t rows);
+    void close();
+
+    size_t width() const { return width_; }
+    size_t height() const { return height_; }
+
+protected:
+    File file_;
+    size_t width_;
+    size_t height_;
+    size_t stride_;
+    std::vector<uint8_t> row_;
+};
+
+#endif /* FILE_BMP_HPP */
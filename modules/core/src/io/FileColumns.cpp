@@ -0,0 +1,395 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file FileColumns.cpp */
+
+#include <Endian.hpp>
+#include <Error.hpp>
+#include <File.hpp>
+#include <FileColumns.hpp>
+#include <FileIndex.hpp>
+#include <FileIndexBuilder.hpp>
+#include <FileLas.hpp>
+#include <FileLasCompression.hpp>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#define FILE_COLUMNS_CHUNK_MAJOR_VERSION 1
+#define FILE_COLUMNS_CHUNK_MINOR_VERSION 0
+#define FILE_COLUMNS_HEADER_SIZE 64
+#define FILE_COLUMNS_HEADER_COUNT 8
+#define FILE_COLUMNS_NODE_SIZE 48
+#define FILE_COLUMNS_POSITION_MAX 16777216.0 /**< Exact integers in float */
+
+const uint32_t FileColumns::CHUNK_TYPE = 0x314C4F43U; /**< Signature "COL1" */
+
+static const size_t FILE_COLUMNS_SIZE[FileColumns::COLUMN_COUNT] =
+    {12, 2, 6, 1, 1, 1, 1, 8, 4, 6};
+
+static const size_t FILE_COLUMNS_ELEMENT_SIZE[FileColumns::COLUMN_COUNT] =
+    {4, 2, 2, 1, 1, 1, 1, 8, 4, 2};
+
+/** Convert column values between host and little endian in place. */
+static void fileColumnsSwap(uint8_t *buffer, size_t nbyte, size_t elementSize)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    for (size_t i = 0; i + elementSize <= nbyte; i += elementSize)
+    {
+        std::reverse(buffer + i, buffer + i + elementSize);
+    }
+#else
+    (void)buffer;
+    (void)nbyte;
+    (void)elementSize;
+#endif
+}
+
+FileColumns::FileColumns()
+{
+}
+
+FileColumns::~FileColumns()
+{
+}
+
+void FileColumns::clear()
+{
+    path_.clear();
+    nodes_.clear();
+}
+
+size_t FileColumns::columnSize(Column column)
+{
+    return FILE_COLUMNS_SIZE[column];
+}
+
+uint64_t FileColumns::columnOffset(const Node &node, Column column)
+{
+    // Column blocks are aligned to 8 bytes
+    uint64_t offset = node.offset;
+    for (size_t i = 0; i < static_cast<size_t>(column); i++)
+    {
+        uint64_t n = node.size * FILE_COLUMNS_SIZE[i];
+        offset += (n + 7U) & ~static_cast<uint64_t>(7U);
+    }
+    return offset;
+}
+
+std::string FileColumns::extension(const std::string &path)
+{
+    return File::replaceExtension(path, ".col");
+}
+
+void FileColumns::read(const std::string &path)
+{
+    clear();
+
+    FileChunk file;
+    file.open(path, "r");
+
+    FileChunk::Chunk chunk;
+    std::vector<uint64_t> header;
+    readHeader(file, chunk, header);
+
+    size_t n = static_cast<size_t>(header[0]);
+    std::vector<uint8_t> buffer(n * FILE_COLUMNS_NODE_SIZE);
+    file.read(buffer.data(), buffer.size());
+    file.close();
+
+    nodes_.resize(n);
+    const uint8_t *ptr = buffer.data();
+    for (size_t i = 0; i < n; i++)
+    {
+        nodes_[i].origin.set(ltohd(&ptr[0]), ltohd(&ptr[8]), ltohd(&ptr[16]));
+        nodes_[i].size = ltoh64(&ptr[24]);
+        nodes_[i].offset = ltoh64(&ptr[32]);
+        ptr += FILE_COLUMNS_NODE_SIZE;
+    }
+
+    path_ = path;
+}
+
+void FileColumns::read(uint8_t *buffer, size_t idx, Column column) const
+{
+    const Node &node = nodes_[idx];
+    size_t nbyte = static_cast<size_t>(node.size) * FILE_COLUMNS_SIZE[column];
+    File::read(buffer, path_, nbyte, columnOffset(node, column));
+    fileColumnsSwap(buffer, nbyte, FILE_COLUMNS_ELEMENT_SIZE[column]);
+}
+
+void FileColumns::readHeader(FileChunk &file,
+                             FileChunk::Chunk &chunk,
+                             std::vector<uint64_t> &header)
+{
+    file.read(chunk);
+    file.validate(chunk,
+                  CHUNK_TYPE,
+                  FILE_COLUMNS_CHUNK_MAJOR_VERSION,
+                  FILE_COLUMNS_CHUNK_MINOR_VERSION);
+
+    if (chunk.headerLength < FILE_COLUMNS_HEADER_SIZE)
+    {
+        THROW("Invalid columns header in '" + file.path() + "'");
+    }
+
+    std::vector<uint8_t> buffer(chunk.headerLength);
+    file.read(buffer.data(), buffer.size());
+
+    header.resize(FILE_COLUMNS_HEADER_COUNT);
+    for (size_t i = 0; i < FILE_COLUMNS_HEADER_COUNT; i++)
+    {
+        header[i] = ltoh64(&buffer[i * 8]);
+    }
+
+    if (header[6] != COLUMN_COUNT)
+    {
+        THROW("Unsupported columns in '" + file.path() + "'");
+    }
+}
+
+bool FileColumns::isValid(const std::string &lasPath)
+{
+    try
+    {
+        const std::string path = extension(lasPath);
+        const std::string pathIndex = FileIndexBuilder::extension(lasPath);
+
+        FileChunk file;
+        file.open(path, "r");
+
+        FileChunk::Chunk chunk;
+        std::vector<uint64_t> header;
+        readHeader(file, chunk, header);
+        file.close();
+
+        return header[2] == File::fileSize(lasPath) &&
+               header[3] == File::fileModified(lasPath) &&
+               header[4] == File::fileSize(pathIndex) &&
+               header[5] == File::fileModified(pathIndex);
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+void FileColumns::create(const std::string &lasPath)
+{
+    const std::string path = extension(lasPath);
+    const std::string pathIndex = FileIndexBuilder::extension(lasPath);
+    const std::string pathTmp = File::tmpname(path);
+
+    // Input
+    std::vector<uint64_t> header(FILE_COLUMNS_HEADER_COUNT);
+    header[2] = File::fileSize(lasPath);
+    header[3] = File::fileModified(lasPath);
+    header[4] = File::fileSize(pathIndex);
+    header[5] = File::fileModified(pathIndex);
+    header[6] = COLUMN_COUNT;
+
+    FileIndex index;
+    index.read(pathIndex);
+
+    FileLas las;
+    las.open(lasPath);
+    las.readHeader();
+
+    // Layout
+    size_t n = index.size();
+    std::vector<Node> nodes(n);
+    uint64_t offset = FileChunk::CHUNK_HEADER_SIZE + FILE_COLUMNS_HEADER_SIZE +
+                      (n * FILE_COLUMNS_NODE_SIZE);
+    uint64_t dataStart = offset;
+    uint64_t maxSize = 0;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        nodes[i].size = index.at(i)->size;
+        nodes[i].offset = offset;
+        offset = columnOffset(nodes[i], COLUMN_COUNT);
+        maxSize = std::max(maxSize, nodes[i].size);
+        header[1] += nodes[i].size;
+    }
+
+    header[0] = n;
+
+    FileChunk::Chunk chunk;
+    chunk.type = CHUNK_TYPE;
+    chunk.majorVersion = FILE_COLUMNS_CHUNK_MAJOR_VERSION;
+    chunk.minorVersion = FILE_COLUMNS_CHUNK_MINOR_VERSION;
+    chunk.headerLength = FILE_COLUMNS_HEADER_SIZE;
+    chunk.dataLength = offset - FileChunk::CHUNK_HEADER_SIZE -
+                       FILE_COLUMNS_HEADER_SIZE;
+
+    // Output
+    FileChunk file;
+    file.open(pathTmp, "w");
+    file.write(chunk);
+
+    std::vector<uint8_t> buffer(FILE_COLUMNS_HEADER_SIZE);
+    for (size_t i = 0; i < FILE_COLUMNS_HEADER_COUNT; i++)
+    {
+        htol64(&buffer[i * 8], header[i]);
+    }
+    file.write(buffer.data(), buffer.size());
+
+    // Node table is written after origins are known
+    file.seek(dataStart);
+
+    // Columns
+    size_t m = static_cast<size_t>(maxSize);
+    size_t pointSize = las.header.point_data_record_length;
+    std::vector<uint8_t> points(m * pointSize);
+    std::vector<double> xyz(m * 3);
+    std::vector<float> position(m * 3);
+    std::vector<uint8_t> block(m * 12 + 8);
+
+    FileLas::Columns columns;
+    columns.xyz = xyz.data();
+
+    for (size_t i = 0; i < n; i++)
+    {
+        Node &node = nodes[i];
+        size_t size = static_cast<size_t>(node.size);
+        if (size == 0)
+        {
+            continue;
+        }
+
+        if (las.header.point_data_compressed)
+        {
+            FileLasCompression::readNode(points.data(),
+                                         las,
+                                         pathIndex,
+                                         *index.at(i));
+        }
+        else
+        {
+            uint64_t from = index.at(i)->from;
+            las.seek(las.header.offset_to_point_data + (from * pointSize));
+            las.file().read(points.data(), size * pointSize);
+        }
+        las.readPoints(columns, points.data(), size);
+
+        // Origin
+        for (size_t k = 0; k < 3; k++)
+        {
+            double min = std::numeric_limits<double>::max();
+            double max = std::numeric_limits<double>::lowest();
+            for (size_t j = 0; j < size; j++)
+            {
+                min = std::min(min, xyz[j * 3 + k]);
+                max = std::max(max, xyz[j * 3 + k]);
+            }
+
+            if (max - min >= FILE_COLUMNS_POSITION_MAX)
+            {
+                file.close();
+                File::remove(pathTmp);
+                THROW("Node extent exceeds precision of columns in '" + path +
+                      "'");
+            }
+
+            node.origin[k] = min;
+        }
+
+        // Write blocks
+        for (size_t c = 0; c < COLUMN_COUNT; c++)
+        {
+            Column column = static_cast<Column>(c);
+            size_t nbyte = size * FILE_COLUMNS_SIZE[c];
+            uint8_t *ptr = block.data();
+            FileLas::Columns values;
+
+            std::memset(ptr, 0, (nbyte + 7U) & ~static_cast<size_t>(7U));
+
+            switch (column)
+            {
+                case COLUMN_POSITION:
+                    for (size_t j = 0; j < size * 3; j++)
+                    {
+                        position[j] =
+                            static_cast<float>(xyz[j] - node.origin[j % 3]);
+                    }
+                    std::memcpy(ptr, position.data(), nbyte);
+                    break;
+                case COLUMN_INTENSITY:
+                    values.intensity = reinterpret_cast<uint16_t *>(ptr);
+                    break;
+                case COLUMN_COLOR:
+                    values.rgb = reinterpret_cast<uint16_t *>(ptr);
+                    break;
+                case COLUMN_RETURN_NUMBER:
+                    values.returnNumber = ptr;
+                    break;
+                case COLUMN_NUMBER_OF_RETURNS:
+                    values.numberOfReturns = ptr;
+                    break;
+                case COLUMN_CLASSIFICATION:
+                    values.classification = ptr;
+                    break;
+                case COLUMN_USER_DATA:
+                    values.userData = ptr;
+                    break;
+                case COLUMN_GPS_TIME:
+                    values.gpsTime = reinterpret_cast<double *>(ptr);
+                    break;
+                case COLUMN_LAYER:
+                    values.userLayer = reinterpret_cast<uint32_t *>(ptr);
+                    break;
+                case COLUMN_USER_COLOR:
+                    values.userRgb = reinterpret_cast<uint16_t *>(ptr);
+                    break;
+                case COLUMN_COUNT:
+                default:
+                    break;
+            }
+
+            if (column != COLUMN_POSITION)
+            {
+                las.readPoints(values, points.data(), size);
+            }
+
+            fileColumnsSwap(ptr, nbyte, FILE_COLUMNS_ELEMENT_SIZE[c]);
+
+            file.write(ptr, (nbyte + 7U) & ~static_cast<size_t>(7U));
+        }
+    }
+
+    // Node table
+    buffer.resize(n * FILE_COLUMNS_NODE_SIZE);
+    uint8_t *ptr = buffer.data();
+    for (size_t i = 0; i < n; i++)
+    {
+        htold(&ptr[0], nodes[i].origin[0]);
+        htold(&ptr[8], nodes[i].origin[1]);
+        htold(&ptr[16], nodes[i].origin[2]);
+        htol64(&ptr[24], nodes[i].size);
+        htol64(&ptr[32], nodes[i].offset);
+        htol64(&ptr[40], 0);
+        ptr += FILE_COLUMNS_NODE_SIZE;
+    }
+
+    file.seek(FileChunk::CHUNK_HEADER_SIZE + FILE_COLUMNS_HEADER_SIZE);
+    file.write(buffer.data(), buffer.size());
+    file.close();
+
+    File::move(path, pathTmp);
+}
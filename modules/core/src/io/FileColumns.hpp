@@ -0,0 +1,95 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file FileColumns.hpp */
+
+#ifndef FILE_COLUMNS_HPP
+#define FILE_COLUMNS_HPP
+
+#include <FileChunk.hpp>
+#include <Vector3.hpp>
+#include <string>
+#include <vector>
+
+/** File Columns.
+    Optional sidecar file of a LAS file with pre-decoded point columns.
+    Points are grouped by the nodes of the main index. Each node stores
+    contiguous blocks of column values in the same point order as LAS.
+    Positions are float offsets from the node origin.
+    The file is valid only for LAS and index files with the same size and
+    modification time as recorded during the creation.
+*/
+class FileColumns
+{
+public:
+    static const uint32_t CHUNK_TYPE;
+
+    /** File Columns Column. */
+    enum Column
+    {
+        COLUMN_POSITION,          /**< float [x, y, z] relative to origin */
+        COLUMN_INTENSITY,         /**< uint16_t */
+        COLUMN_COLOR,             /**< uint16_t [r, g, b] */
+        COLUMN_RETURN_NUMBER,     /**< uint8_t */
+        COLUMN_NUMBER_OF_RETURNS, /**< uint8_t */
+        COLUMN_CLASSIFICATION,    /**< uint8_t */
+        COLUMN_USER_DATA,         /**< uint8_t */
+        COLUMN_GPS_TIME,          /**< double */
+        COLUMN_LAYER,             /**< uint32_t */
+        COLUMN_USER_COLOR,        /**< uint16_t [r, g, b] */
+        COLUMN_COUNT
+    };
+
+    /** File Columns Node. */
+    struct Node
+    {
+        Vector3<double> origin;
+        uint64_t size;
+        uint64_t offset;
+    };
+
+    FileColumns();
+    ~FileColumns();
+
+    void clear();
+    bool empty() const { return nodes_.empty(); }
+
+    size_t size() const { return nodes_.size(); }
+    const Node &at(size_t idx) const { return nodes_[idx]; }
+
+    void read(const std::string &path);
+    void read(uint8_t *buffer, size_t idx, Column column) const;
+
+    static size_t columnSize(Column column);
+    static uint64_t columnOffset(const Node &node, Column column);
+
+    static std::string extension(const std::string &path);
+    static bool isValid(const std::string &lasPath);
+    static void create(const std::string &lasPath);
+
+protected:
+    std::string path_;
+    std::vector<Node> nodes_;
+
+    static void readHeader(FileChunk &file,
+                           FileChunk::Chunk &chunk,
+                           std::vector<uint64_t> &header);
+};
+
+#endif /* FILE_COLUMNS_HPP */
@@ -20,17 +20,99 @@
 /** @file FileIndex.cpp */
 
 #include <Endian.hpp>
+#include <Error.hpp>
 #include <FileIndex.hpp>
+#include <algorithm>
 #include <cstring>
 #include <queue>
 
 const uint32_t FileIndex::CHUNK_TYPE = 0x38584449U; /**< Signature "IDX8" */
+const uint32_t FileIndex::CHUNK_TYPE_SUMMARY = 0x384D5553U; /**< "SUM8" */
 #define OCTREE_INDEX_CHUNK_MAJOR_VERSION 1
-#define OCTREE_INDEX_CHUNK_MINOR_VERSION 0
+#define OCTREE_INDEX_CHUNK_MINOR_VERSION 1
 #define OCTREE_INDEX_MAX_LEVEL 17
 #define OCTREE_INDEX_HEADER_SIZE_1_0 104
+#define OCTREE_INDEX_HEADER_SIZE_1_1 112
+#define OCTREE_INDEX_FLAG_DATA 0x1U
+#define OCTREE_SUMMARY_CHUNK_MAJOR_VERSION 1
+#define OCTREE_SUMMARY_CHUNK_MINOR_VERSION 0
+#define OCTREE_SUMMARY_HEADER_SIZE 8
+#define OCTREE_SUMMARY_NODE_SIZE 80
+
+FileIndex::Summary::Summary()
+{
+    clear();
+}
+
+void FileIndex::Summary::clear()
+{
+    for (size_t i = 0; i < 8; i++)
+    {
+        classes[i] = 0;
+    }
+
+    // Empty ranges
+    layerMin = std::numeric_limits<uint32_t>::max();
+    layerMax = 0;
+    zMin = std::numeric_limits<double>::max();
+    zMax = -std::numeric_limits<double>::max();
+    gpsTimeMin = std::numeric_limits<double>::max();
+    gpsTimeMax = -std::numeric_limits<double>::max();
+    intensityMin = std::numeric_limits<uint16_t>::max();
+    intensityMax = 0;
+    returnNumberMin = std::numeric_limits<uint8_t>::max();
+    returnNumberMax = 0;
+}
+
+void FileIndex::Summary::add(uint8_t classification,
+                             uint32_t layer,
+                             double z,
+                             double gpsTime,
+                             uint16_t intensity,
+                             uint8_t returnNumber)
+{
+    classes[classification >> 5] |= 1U << (classification & 31U);
+    layerMin = std::min(layerMin, layer);
+    layerMax = std::max(layerMax, layer);
+    zMin = std::min(zMin, z);
+    zMax = std::max(zMax, z);
+    gpsTimeMin = std::min(gpsTimeMin, gpsTime);
+    gpsTimeMax = std::max(gpsTimeMax, gpsTime);
+    intensityMin = std::min(intensityMin, intensity);
+    intensityMax = std::max(intensityMax, intensity);
+    returnNumberMin = std::min(returnNumberMin, returnNumber);
+    returnNumberMax = std::max(returnNumberMax, returnNumber);
+}
+
+Json &FileIndex::Summary::write(Json &out) const
+{
+    size_t n = 0;
+    for (size_t i = 0; i < 256; i++)
+    {
+        if (hasClass(i))
+        {
+            out["classes"][n++] = i;
+        }
+    }
+
+    if (!empty())
+    {
+        out["layer"][0] = layerMin;
+        out["layer"][1] = layerMax;
+        out["z"][0] = zMin;
+        out["z"][1] = zMax;
+        out["gpsTime"][0] = gpsTimeMin;
+        out["gpsTime"][1] = gpsTimeMax;
+        out["intensity"][0] = intensityMin;
+        out["intensity"][1] = intensityMax;
+        out["returnNumber"][0] = returnNumberMin;
+        out["returnNumber"][1] = returnNumberMax;
+    }
 
-FileIndex::FileIndex()
+    return out;
+}
+
+FileIndex::FileIndex() : hasData_(false)
 {
 }
 
@@ -45,6 +127,8 @@ void FileIndex::clear()
     boundaryFile_.clear();
     boundaryPoints_.clear();
     boundaryPointsFile_.clear();
+    summary_.clear();
+    hasData_ = false;
     root_.reset();
 }
 
@@ -390,6 +474,35 @@ Aabb<double> FileIndex::boundary(const Node *node,
     return boundary;
 }
 
+void FileIndex::createSummary()
+{
+    summary_.clear();
+    summary_.resize(nodes_.size());
+}
+
+const FileIndex::Summary *FileIndex::summary(const Node *node) const
+{
+    if (summary_.empty())
+    {
+        return nullptr;
+    }
+
+    return &summary_[static_cast<size_t>(node - nodes_.data())];
+}
+
+bool FileIndex::isLeaf(const Node *node) const
+{
+    for (size_t i = 0; i < 8; i++)
+    {
+        if (node->next[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 void FileIndex::insertBegin(const Aabb<double> &boundary,
                             const Aabb<double> &boundaryPoints,
                             size_t maxSize,
@@ -652,6 +765,68 @@ void FileIndex::read(FileChunk &file)
 
     // Chunk payload
     readPayload(file, chunk);
+
+    // Optional node summaries follow the index chunk
+    summary_.clear();
+    uint64_t offset = file.offset();
+    if (offset + FileChunk::CHUNK_HEADER_SIZE <= file.size())
+    {
+        file.read(chunk);
+        if (chunk.type == CHUNK_TYPE_SUMMARY)
+        {
+            readSummary(file, chunk);
+        }
+        else
+        {
+            file.seek(offset);
+        }
+    }
+}
+
+void FileIndex::readSummary(FileChunk &file, const FileChunk::Chunk &chunk)
+{
+    file.validate(chunk,
+                  CHUNK_TYPE_SUMMARY,
+                  OCTREE_SUMMARY_CHUNK_MAJOR_VERSION,
+                  OCTREE_SUMMARY_CHUNK_MINOR_VERSION);
+
+    std::vector<uint8_t> buffer;
+    buffer.resize(chunk.headerLength + chunk.dataLength);
+    uint8_t *ptr = buffer.data();
+
+    // Header
+    file.read(ptr, chunk.headerLength);
+
+    size_t n = static_cast<size_t>(ltoh64(&ptr[0]));
+    if (n != nodes_.size() || chunk.dataLength < n * OCTREE_SUMMARY_NODE_SIZE)
+    {
+        THROW("Index summary does not match index in '" + file.path() + "'");
+    }
+
+    // Data
+    summary_.resize(n);
+
+    file.read(ptr, chunk.dataLength);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        Summary &s = summary_[i];
+        for (size_t j = 0; j < 8; j++)
+        {
+            s.classes[j] = ltoh32(ptr + (j * 4));
+        }
+        s.layerMin = ltoh32(ptr + 32);
+        s.layerMax = ltoh32(ptr + 36);
+        s.zMin = ltohd(ptr + 40);
+        s.zMax = ltohd(ptr + 48);
+        s.gpsTimeMin = ltohd(ptr + 56);
+        s.gpsTimeMax = ltohd(ptr + 64);
+        s.intensityMin = ltoh16(ptr + 72);
+        s.intensityMax = ltoh16(ptr + 74);
+        s.returnNumberMin = ptr[76];
+        s.returnNumberMax = ptr[77];
+        ptr += OCTREE_SUMMARY_NODE_SIZE;
+    }
 }
 
 void FileIndex::readPayload(FileChunk &file, const FileChunk::Chunk &chunk)
@@ -687,6 +862,13 @@ void FileIndex::readPayload(FileChunk &file, const FileChunk::Chunk &chunk)
     boundaryPointsFile_.set(wx1, wy1, wz1, wx2, wy2, wz2);
     boundaryPoints_ = boundaryPointsFile_;
 
+    uint64_t flags = 0;
+    if (chunk.headerLength >= OCTREE_INDEX_HEADER_SIZE_1_1)
+    {
+        flags = ltoh64(&ptr[8 + (12 * 8)]);
+    }
+    hasData_ = (flags & OCTREE_INDEX_FLAG_DATA) != 0;
+
     // Data
     nodes_.resize(n);
     std::memset(nodes_.data(), 0, sizeof(Node) * n);
@@ -719,6 +901,13 @@ void FileIndex::readPayload(FileChunk &file, const FileChunk::Chunk &chunk)
         nodes_[i].size = ltoh64(ptr + 8);
         nodes_[i].offset = ltoh64(ptr + 16);
         ptr += 24;
+
+        if (flags & OCTREE_INDEX_FLAG_DATA)
+        {
+            nodes_[i].dataOffset = ltoh64(ptr);
+            nodes_[i].dataSize = ltoh64(ptr + 8);
+            ptr += 16;
+        }
     }
 }
 
@@ -736,9 +925,20 @@ void FileIndex::write(FileChunk &file) const
     FileChunk::Chunk chunk;
     chunk.type = CHUNK_TYPE;
     chunk.majorVersion = OCTREE_INDEX_CHUNK_MAJOR_VERSION;
-    chunk.minorVersion = OCTREE_INDEX_CHUNK_MINOR_VERSION;
+    chunk.minorVersion = 0;
     chunk.headerLength = OCTREE_INDEX_HEADER_SIZE_1_0;
 
+    // Version 1.1 is written only with compressed point data
+    uint64_t flags = 0;
+    size_t nodeSize = 32;
+    if (hasData_)
+    {
+        chunk.minorVersion = OCTREE_INDEX_CHUNK_MINOR_VERSION;
+        chunk.headerLength = OCTREE_INDEX_HEADER_SIZE_1_1;
+        flags |= OCTREE_INDEX_FLAG_DATA;
+        nodeSize += 16;
+    }
+
     // Chunk size
     chunk.dataLength = 0;
     std::vector<uint32_t> headers;
@@ -763,7 +963,7 @@ void FileIndex::write(FileChunk &file) const
         chunk.dataLength += c;
     }
     chunk.dataLength *= 4;
-    chunk.dataLength += nodes_.size() * 32;
+    chunk.dataLength += nodes_.size() * nodeSize;
 
     // Chunk write
     file.write(chunk);
@@ -786,6 +986,10 @@ void FileIndex::write(FileChunk &file) const
     htold(&ptr[8 + (9 * 8)], boundaryPointsFile_.max(0));
     htold(&ptr[8 + (10 * 8)], boundaryPointsFile_.max(1));
     htold(&ptr[8 + (11 * 8)], boundaryPointsFile_.max(2));
+    if (flags)
+    {
+        htol64(&ptr[8 + (12 * 8)], flags);
+    }
     file.write(buffer.data(), chunk.headerLength);
 
     // Data
@@ -815,6 +1019,63 @@ void FileIndex::write(FileChunk &file) const
         htol64(ptr + 8, nodes_[i].size);
         htol64(ptr + 16, nodes_[i].offset);
         ptr += 24;
+
+        if (flags & OCTREE_INDEX_FLAG_DATA)
+        {
+            htol64(ptr, nodes_[i].dataOffset);
+            htol64(ptr + 8, nodes_[i].dataSize);
+            ptr += 16;
+        }
+    }
+    file.write(buffer.data(), chunk.dataLength);
+
+    // Optional node summaries
+    if (!summary_.empty())
+    {
+        writeSummary(file);
+    }
+}
+
+void FileIndex::writeSummary(FileChunk &file) const
+{
+    // Chunk
+    FileChunk::Chunk chunk;
+    chunk.type = CHUNK_TYPE_SUMMARY;
+    chunk.majorVersion = OCTREE_SUMMARY_CHUNK_MAJOR_VERSION;
+    chunk.minorVersion = OCTREE_SUMMARY_CHUNK_MINOR_VERSION;
+    chunk.headerLength = OCTREE_SUMMARY_HEADER_SIZE;
+    chunk.dataLength = summary_.size() * OCTREE_SUMMARY_NODE_SIZE;
+
+    file.write(chunk);
+
+    // Header
+    std::vector<uint8_t> buffer;
+    buffer.resize(chunk.headerLength + chunk.dataLength);
+    uint8_t *ptr = buffer.data();
+
+    htol64(&ptr[0], summary_.size());
+    file.write(buffer.data(), chunk.headerLength);
+
+    // Data
+    std::memset(ptr, 0, chunk.dataLength);
+    for (size_t i = 0; i < summary_.size(); i++)
+    {
+        const Summary &s = summary_[i];
+        for (size_t j = 0; j < 8; j++)
+        {
+            htol32(ptr + (j * 4), s.classes[j]);
+        }
+        htol32(ptr + 32, s.layerMin);
+        htol32(ptr + 36, s.layerMax);
+        htold(ptr + 40, s.zMin);
+        htold(ptr + 48, s.zMax);
+        htold(ptr + 56, s.gpsTimeMin);
+        htold(ptr + 64, s.gpsTimeMax);
+        htol16(ptr + 72, s.intensityMin);
+        htol16(ptr + 74, s.intensityMax);
+        ptr[76] = s.returnNumberMin;
+        ptr[77] = s.returnNumberMax;
+        ptr += OCTREE_SUMMARY_NODE_SIZE;
     }
     file.write(buffer.data(), chunk.dataLength);
 }
@@ -834,6 +1095,11 @@ Json &FileIndex::write(Json &out, const Node *data, size_t idx) const
     out["from"] = data[idx].from;
     out["count"] = data[idx].size;
 
+    if (!summary_.empty())
+    {
+        summary_[idx].write(out["summary"]);
+    }
+
     size_t used = 0;
     for (size_t i = 0; i < 8; i++)
     {
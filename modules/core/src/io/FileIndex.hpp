@@ -33,6 +33,7 @@ class FileIndex
 {
 public:
     static const uint32_t CHUNK_TYPE;
+    static const uint32_t CHUNK_TYPE_SUMMARY;
 
     /** File Index Node. */
     struct Node
@@ -43,6 +44,45 @@ public:
         uint32_t reserved;
         uint32_t prev;
         uint32_t next[8];
+
+        // Compressed point data relative to the start of point data
+        uint64_t dataOffset;
+        uint64_t dataSize;
+    };
+
+    /** File Index Node Summary.
+        Attribute ranges of points in a node (zone map). L1 nodes
+        summarize their own points, L2 nodes the points of their subtree.
+        Elevation is in the unscaled coordinates of the index.
+    */
+    struct Summary
+    {
+        uint32_t classes[8]; // Bitset of classifications
+        uint32_t layerMin;
+        uint32_t layerMax;
+        double zMin;
+        double zMax;
+        double gpsTimeMin;
+        double gpsTimeMax;
+        uint16_t intensityMin;
+        uint16_t intensityMax;
+        uint8_t returnNumberMin;
+        uint8_t returnNumberMax;
+
+        Summary();
+        void clear();
+        bool empty() const { return layerMin > layerMax; }
+        bool hasClass(size_t c) const
+        {
+            return (classes[c >> 5] & (1U << (c & 31U))) != 0;
+        }
+        void add(uint8_t classification,
+                 uint32_t layer,
+                 double z,
+                 double gpsTime,
+                 uint16_t intensity,
+                 uint8_t returnNumber);
+        Json &write(Json &out) const;
     };
 
     /** File Index Selection. */
@@ -88,12 +128,24 @@ public:
     const Node *at(size_t idx) const { return &nodes_[idx]; }
     Node *at(size_t idx) { return &nodes_[idx]; }
     Aabb<double> boundary(const Node *node, const Aabb<double> &box) const;
+    bool isLeaf(const Node *node) const;
+
+    // Compressed point data
+    bool hasData() const { return hasData_; }
+    void setHasData(bool hasData) { hasData_ = hasData; }
+
+    // Node summaries
+    bool hasSummary() const { return !summary_.empty(); }
+    void createSummary();
+    const Summary *summary(const Node *node) const;
+    Summary *summary(size_t idx) { return &summary_[idx]; }
 
     // IO
     void read(const std::string &path);
     void read(const std::string &path, uint64_t offset);
     void read(FileChunk &file);
     void readPayload(FileChunk &file, const FileChunk::Chunk &chunk);
+    void readSummary(FileChunk &file, const FileChunk::Chunk &chunk);
     void write(const std::string &path) const;
     void write(FileChunk &file) const;
     Json &write(Json &out) const;
@@ -113,6 +165,8 @@ protected:
     Aabb<double> boundaryPoints_;
     Aabb<double> boundaryPointsFile_;
     std::vector<Node> nodes_;
+    std::vector<Summary> summary_;
+    bool hasData_;
 
     void selectLeaves(std::vector<Selection> &idxList,
                       const Aabb<double> &window,
@@ -145,6 +199,7 @@ protected:
                 double z,
                 uint64_t code) const;
 
+    void writeSummary(FileChunk &file) const;
     Json &write(Json &out, const Node *data, size_t idx) const;
 
     // Build tree
@@ -20,6 +20,7 @@
 /** @file FileIndexBuilder.cpp */
 
 #include <Endian.hpp>
+#include <Error.hpp>
 #include <FileIndexBuilder.hpp>
 #include <Vector3.hpp>
 #include <cstring>
@@ -40,6 +41,8 @@ FileIndexBuilder::Settings::Settings()
     // maxLevel2 = 2;
 
     bufferSize = 5 * 1024 * 1024;
+
+    compressed = false;
 }
 
 FileIndexBuilder::Settings::~Settings()
@@ -49,7 +52,8 @@ FileIndexBuilder::Settings::~Settings()
 FileIndexBuilder::FileIndexBuilder()
     : state_(STATE_NONE),
       valueTotal_(0),
-      maximumTotal_(0)
+      maximumTotal_(0),
+      compressedSize_(0)
 {
 }
 
@@ -149,6 +153,11 @@ void FileIndexBuilder::openFiles()
     inputLas_.open(readPath_);
     inputLas_.readHeader();
 
+    if (inputLas_.header.point_data_compressed)
+    {
+        THROW("LAS '" + readPath_ + "' is already compressed");
+    }
+
     sizePointFormat_ = inputLas_.header.pointDataRecordLengthFormat();
     sizePoint_ = inputLas_.header.point_data_record_length;
     sizePoints_ = inputLas_.header.pointDataSize();
@@ -286,6 +295,10 @@ void FileIndexBuilder::next()
             stateNodeEnd();
             break;
 
+        case STATE_COMPRESS:
+            stateCompress();
+            break;
+
         case STATE_END:
             stateEnd();
             break;
@@ -383,6 +396,17 @@ void FileIndexBuilder::nextState()
             break;
 
         case STATE_NODE_END:
+            if (settings_.compressed)
+            {
+                state_ = STATE_COMPRESS;
+            }
+            else
+            {
+                state_ = STATE_END;
+            }
+            break;
+
+        case STATE_COMPRESS:
             state_ = STATE_END;
             break;
 
@@ -573,9 +597,9 @@ void FileIndexBuilder::stateCopyPoints()
         std::memcpy(out, in, sizePoint_); // sizePointFormat_
 
         // Boundary of points without scaling and offset
-        coords_[i * 3 + 0] = static_cast<double>(ltoh32(out + 0));
-        coords_[i * 3 + 1] = static_cast<double>(ltoh32(out + 4));
-        coords_[i * 3 + 2] = static_cast<double>(ltoh32(out + 8));
+        coords_[i * 3 + 0] = static_cast<double>(ltohs32(out + 0));
+        coords_[i * 3 + 1] = static_cast<double>(ltohs32(out + 4));
+        coords_[i * 3 + 2] = static_cast<double>(ltohs32(out + 8));
 
         // Format
         if (hasDifferentFormat)
@@ -684,9 +708,9 @@ void FileIndexBuilder::stateMainInsert()
     for (uint64_t i = 0; i < stepIdx; i++)
     {
         point = buffer + (i * sizePoint_);
-        x = static_cast<double>(ltoh32(point + 0));
-        y = static_cast<double>(ltoh32(point + 4));
-        z = static_cast<double>(ltoh32(point + 8));
+        x = static_cast<double>(ltohs32(point + 0));
+        y = static_cast<double>(ltohs32(point + 4));
+        z = static_cast<double>(ltohs32(point + 8));
         (void)indexMain_.insert(x, y, z);
     }
 
@@ -699,6 +723,8 @@ void FileIndexBuilder::stateMainInsert()
 void FileIndexBuilder::stateMainEnd()
 {
     indexMain_.insertEnd();
+    indexMain_.setHasData(settings_.compressed);
+    indexMain_.createSummary();
 
     // Write main index
     std::string indexPath = extension(outputPath_);
@@ -742,9 +768,9 @@ void FileIndexBuilder::stateMainSort()
     for (uint64_t i = 0; i < stepIdx; i++)
     {
         point = buffer + (i * sizePoint_);
-        x = static_cast<double>(ltoh32(point + 0));
-        y = static_cast<double>(ltoh32(point + 4));
-        z = static_cast<double>(ltoh32(point + 8));
+        x = static_cast<double>(ltohs32(point + 0));
+        y = static_cast<double>(ltohs32(point + 4));
+        z = static_cast<double>(ltohs32(point + 8));
 
         // Normalize unscaled values
         if (intensityMax_ > 0 && intensityMax_ < 256)
@@ -792,6 +818,13 @@ void FileIndexBuilder::stateMainSort()
 
 void FileIndexBuilder::stateNodeBegin()
 {
+    if (settings_.compressed)
+    {
+        compression_.setFormat(outputLas_.header);
+        compressedPath_ = File::tmpname(writePath_);
+        compressedFile_.open(compressedPath_, "w");
+        compressedSize_ = 0;
+    }
 }
 
 static int FileIndexBuilderCmp(const void *a, const void *b)
@@ -839,9 +872,9 @@ void FileIndexBuilder::stateNodeInsert()
     for (uint64_t i = 0; i < node->size; i++)
     {
         point = buffer + (i * sizePoint_);
-        coords_[i * 3 + 0] = static_cast<double>(ltoh32(point + 0));
-        coords_[i * 3 + 1] = static_cast<double>(ltoh32(point + 4));
-        coords_[i * 3 + 2] = static_cast<double>(ltoh32(point + 8));
+        coords_[i * 3 + 0] = static_cast<double>(ltohs32(point + 0));
+        coords_[i * 3 + 1] = static_cast<double>(ltohs32(point + 4));
+        coords_[i * 3 + 2] = static_cast<double>(ltohs32(point + 8));
     }
 
     Aabb<double> box;
@@ -864,8 +897,7 @@ void FileIndexBuilder::stateNodeInsert()
     }
 
     indexNode_.insertEnd();
-    node->offset = indexFile_.offset();
-    indexNode_.write(indexFile_);
+    indexNode_.setHasData(settings_.compressed);
 
     // Sort
     size_t size = sizeof(uint64_t) * 2;
@@ -886,9 +918,23 @@ void FileIndexBuilder::stateNodeInsert()
         std::memcpy(pointOut, point, sizePoint_);
     }
 
+    // Attribute summaries of this node and its L2 nodes
+    summarizeNode(static_cast<size_t>(valueIdx_), bufferOut);
+
     // Write sorted points
-    outputLas_.seek(start + (node->from * sizePoint_));
-    outputLas_.file().write(bufferOut, step);
+    if (settings_.compressed)
+    {
+        compressNode(node, bufferOut);
+    }
+    else
+    {
+        outputLas_.seek(start + (node->from * sizePoint_));
+        outputLas_.file().write(bufferOut, step);
+    }
+
+    // Write node index
+    node->offset = indexFile_.offset();
+    indexNode_.write(indexFile_);
 
     // Next
     value_ += step;
@@ -904,6 +950,160 @@ void FileIndexBuilder::stateNodeEnd()
     indexFile_.close();
 }
 
+void FileIndexBuilder::summarizeNode(size_t idx, const uint8_t *buffer)
+{
+    const FileIndex::Node *node = indexMain_.at(idx);
+    size_t n = static_cast<size_t>(node->size);
+
+    std::vector<double> xyz;
+    std::vector<uint16_t> intensity;
+    std::vector<uint8_t> returnNumber;
+    std::vector<uint8_t> classification;
+    std::vector<double> gpsTime;
+    std::vector<uint32_t> layer;
+
+    xyz.resize(n * 3);
+    intensity.resize(n);
+    returnNumber.resize(n);
+    classification.resize(n);
+    gpsTime.resize(n);
+    layer.resize(n);
+
+    FileLas::Columns columns;
+    columns.xyz = xyz.data();
+    columns.intensity = intensity.data();
+    columns.returnNumber = returnNumber.data();
+    columns.classification = classification.data();
+    columns.gpsTime = gpsTime.data();
+    columns.userLayer = layer.data();
+
+    outputLas_.readPoints(columns, buffer, n);
+
+    // L1 node contains only its own points
+    FileIndex::Summary *summary = indexMain_.summary(idx);
+    summary->clear();
+    for (size_t i = 0; i < n; i++)
+    {
+        summary->add(classification[i],
+                     layer[i],
+                     xyz[i * 3 + 2],
+                     gpsTime[i],
+                     intensity[i],
+                     returnNumber[i]);
+    }
+
+    // L2 nodes contain continuous blocks of points of their subtree
+    indexNode_.createSummary();
+    for (size_t i = 0; i < indexNode_.size(); i++)
+    {
+        const FileIndex::Node *sub = indexNode_.at(i);
+        summary = indexNode_.summary(i);
+
+        size_t from = static_cast<size_t>(sub->from);
+        size_t to = from + static_cast<size_t>(sub->size);
+        for (size_t j = from; j < to; j++)
+        {
+            summary->add(classification[j],
+                         layer[j],
+                         xyz[j * 3 + 2],
+                         gpsTime[j],
+                         intensity[j],
+                         returnNumber[j]);
+        }
+    }
+}
+
+void FileIndexBuilder::compressNode(FileIndex::Node *node,
+                                    const uint8_t *buffer)
+{
+    std::vector<uint8_t> out;
+
+    // Leaves are ordered by their points
+    node->dataOffset = compressedSize_;
+
+    for (size_t i = 0; i < indexNode_.size(); i++)
+    {
+        FileIndex::Node *leaf = indexNode_.at(i);
+        leaf->dataOffset = compressedSize_;
+        leaf->dataSize = 0;
+
+        if (leaf->size == 0 || !indexNode_.isLeaf(leaf))
+        {
+            continue;
+        }
+
+        out.clear();
+        compression_.compress(out,
+                              buffer + (leaf->from * sizePoint_),
+                              static_cast<size_t>(leaf->size));
+        compressedFile_.write(out.data(), out.size());
+
+        leaf->dataSize = out.size();
+        compressedSize_ += out.size();
+    }
+
+    node->dataSize = compressedSize_ - node->dataOffset;
+
+    // Inner nodes contain continuous blocks of their leaves,
+    // children are stored after their parent
+    for (size_t i = indexNode_.size(); i > 1; i--)
+    {
+        const FileIndex::Node *child = indexNode_.at(i - 1);
+        FileIndex::Node *parent = indexNode_.at(child->prev - 1);
+        parent->dataOffset = child->dataOffset;
+        parent->dataSize += child->dataSize;
+    }
+}
+
+void FileIndexBuilder::stateCompress()
+{
+    compressedFile_.close();
+
+    // Point data are replaced by compressed blocks, the file gets its own
+    // signature so that LAS readers do not decode the blocks as points
+    FileLas::Header header = outputLas_.header;
+    header.point_data_compressed = 1;
+
+    if (compressedSize_ < sizePointsOut_)
+    {
+        header.subOffsetWdpr(sizePointsOut_ - compressedSize_);
+        header.subOffsetEvlr(sizePointsOut_ - compressedSize_);
+    }
+    else
+    {
+        header.addOffsetWdpr(compressedSize_ - sizePointsOut_);
+        header.addOffsetEvlr(compressedSize_ - sizePointsOut_);
+    }
+
+    std::string path = File::tmpname(compressedPath_);
+    FileLas las;
+    las.create(path);
+    las.header = header;
+    las.writeHeader();
+
+    // VLR
+    outputLas_.seek(offsetHeaderEndOut_);
+    las.file().write(outputLas_.file(),
+                     offsetPointsStartOut_ - offsetHeaderEndOut_);
+
+    // Points
+    File points;
+    points.open(compressedPath_, "r");
+    las.file().write(points, compressedSize_);
+    points.close();
+
+    // EVLR
+    outputLas_.seek(offsetPointsEndOut_);
+    las.file().write(outputLas_.file(), sizeFileOut_ - offsetPointsEndOut_);
+
+    las.close();
+    outputLas_.close();
+
+    File::remove(compressedPath_);
+    File::remove(writePath_);
+    writePath_ = path;
+}
+
 void FileIndexBuilder::stateEnd()
 {
     // Cleanup and create the final output file
@@ -25,6 +25,7 @@
 #include <FileChunk.hpp>
 #include <FileIndex.hpp>
 #include <FileLas.hpp>
+#include <FileLasCompression.hpp>
 #include <map>
 #include <string>
 #include <vector>
@@ -47,6 +48,8 @@ public:
 
         size_t bufferSize;
 
+        bool compressed;
+
         Settings();
         ~Settings();
     };
@@ -89,6 +92,7 @@ protected:
         STATE_NODE_BEGIN,
         STATE_NODE_INSERT,
         STATE_NODE_END,
+        STATE_COMPRESS,
         STATE_END
     };
 
@@ -137,6 +141,12 @@ protected:
     std::string readPath_;
     std::string writePath_;
 
+    // Compression
+    FileLasCompression compression_;
+    File compressedFile_;
+    std::string compressedPath_;
+    uint64_t compressedSize_;
+
     // Settings
     FileIndexBuilder::Settings settings_;
 
@@ -158,8 +168,12 @@ protected:
     void stateNodeBegin();
     void stateNodeInsert();
     void stateNodeEnd();
+    void stateCompress();
     void stateEnd();
 
+    void summarizeNode(size_t idx, const uint8_t *buffer);
+    void compressNode(FileIndex::Node *node, const uint8_t *buffer);
+
     void formatPoint(uint8_t *pout, const uint8_t *pin) const;
 };
 
@@ -23,12 +23,18 @@
 #include <Endian.hpp>
 #include <Error.hpp>
 #include <FileLas.hpp>
+#include <algorithm>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <iostream>
 #include <sstream>
 #include <vector>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #define LAS_FILE_SIGNATURE_0 0x4C
 #define LAS_FILE_SIGNATURE_1 0x41
 #define LAS_FILE_SIGNATURE_2 0x53
@@ -37,6 +43,8 @@
 #define LAS_FILE_HEADER_SIZE_V13 235
 #define LAS_FILE_HEADER_SIZE_V14 375
 #define LAS_FILE_FORMAT_COUNT 11
+#define LAS_FILE_SIGNATURE_COMPRESSED "3DFZ"
+#define LAS_FILE_BLOCK_SIZE 256
 
 static const size_t LAS_FILE_FORMAT_BYTE_COUNT[LAS_FILE_FORMAT_COUNT] =
     {20, 28, 26, 34, 57, 63, 30, 36, 38, 59, 67};
@@ -99,11 +107,26 @@ uint64_t FileLas::Header::pointDataSize() const
            number_of_point_records;
 }
 
+bool FileLas::Header::hasGpsTime() const
+{
+    return LAS_FILE_FORMAT_GPS_TIME[point_data_record_format];
+}
+
 bool FileLas::Header::hasRgb() const
 {
     return LAS_FILE_FORMAT_RGB[point_data_record_format];
 }
 
+bool FileLas::Header::hasNir() const
+{
+    return LAS_FILE_FORMAT_NIR[point_data_record_format];
+}
+
+bool FileLas::Header::hasWave() const
+{
+    return LAS_FILE_FORMAT_WAVE[point_data_record_format];
+}
+
 std::string FileLas::Header::dateCreated() const
 {
     // GMT day
@@ -146,6 +169,49 @@ std::string FileLas::Header::dateCreated() const
     return "1970-01-01 00:00:00";
 }
 
+void FileLas::Header::set(uint8_t format,
+                          const std::array<double, 3> &scale,
+                          const std::array<double, 3> &offset,
+                          uint8_t versionMinor)
+{
+    std::memset(this, 0, sizeof(*this));
+
+    file_signature[0] = LAS_FILE_SIGNATURE_0;
+    file_signature[1] = LAS_FILE_SIGNATURE_1;
+    file_signature[2] = LAS_FILE_SIGNATURE_2;
+    file_signature[3] = LAS_FILE_SIGNATURE_3;
+
+    version_major = 1;
+    version_minor = versionMinor;
+    setGeneratingSoftware();
+
+    if (versionMinor > 3)
+    {
+        header_size = LAS_FILE_HEADER_SIZE_V14;
+    }
+    else if (versionMinor > 2)
+    {
+        header_size = LAS_FILE_HEADER_SIZE_V13;
+    }
+    else
+    {
+        header_size = LAS_FILE_HEADER_SIZE_V10;
+    }
+
+    offset_to_point_data = header_size;
+
+    point_data_record_format = format;
+    point_data_record_length =
+        static_cast<uint16_t>(pointDataRecordLength3dForest());
+
+    x_scale_factor = scale[0];
+    y_scale_factor = scale[1];
+    z_scale_factor = scale[2];
+    x_offset = offset[0];
+    y_offset = offset[1];
+    z_offset = offset[2];
+}
+
 void FileLas::Header::setGeneratingSoftware()
 {
     std::memset(generating_software, 0, sizeof(generating_software));
@@ -193,6 +259,7 @@ void FileLas::Header::subOffsetEvlr(uint64_t decrement)
     }
 }
 
+
 FileLas::FileLas()
 {
 }
@@ -209,43 +276,12 @@ void FileLas::create(const std::string &path,
 {
     // Fill header
     FileLas::Header hdr;
-    std::memset(&hdr, 0, sizeof(hdr));
-
-    hdr.file_signature[0] = LAS_FILE_SIGNATURE_0;
-    hdr.file_signature[1] = LAS_FILE_SIGNATURE_1;
-    hdr.file_signature[2] = LAS_FILE_SIGNATURE_2;
-    hdr.file_signature[3] = LAS_FILE_SIGNATURE_3;
-
-    hdr.version_major = 1;
-    hdr.version_minor = version_minor;
-    hdr.setGeneratingSoftware();
-
-    if (version_minor > 3)
-    {
-        hdr.header_size = LAS_FILE_HEADER_SIZE_V14;
-    }
-    else if (version_minor > 2)
-    {
-        hdr.header_size = LAS_FILE_HEADER_SIZE_V13;
-    }
-    else
-    {
-        hdr.header_size = LAS_FILE_HEADER_SIZE_V10;
-    }
-
-    hdr.offset_to_point_data = hdr.header_size;
-
+    uint8_t format = 6;
     if (points.size() > 0)
     {
-        hdr.point_data_record_format = points[0].format;
-    }
-    else
-    {
-        hdr.point_data_record_format = 6;
+        format = points[0].format;
     }
-
-    hdr.point_data_record_length =
-        static_cast<uint16_t>(hdr.pointDataRecordLength3dForest());
+    hdr.set(format, scale, offset, version_minor);
 
     uint64_t nPoints = points.size();
     uint32_t maxPoints = std::numeric_limits<uint32_t>::max();
@@ -259,15 +295,8 @@ void FileLas::create(const std::string &path,
         hdr.legacy_number_of_point_records = static_cast<uint32_t>(nPoints);
     }
 
-    hdr.x_scale_factor = scale[0];
-    hdr.y_scale_factor = scale[1];
-    hdr.z_scale_factor = scale[2];
-    hdr.x_offset = offset[0];
-    hdr.y_offset = offset[1];
-    hdr.z_offset = offset[2];
-
     // Extents of point file data
-    std::vector<uint32_t> coords;
+    std::vector<int32_t> coords;
     coords.resize(points.size() * 3);
     for (size_t i = 0; i < points.size(); i++)
     {
@@ -275,7 +304,7 @@ void FileLas::create(const std::string &path,
         coords[i * 3 + 1] = points[i].y;
         coords[i * 3 + 2] = points[i].z;
     }
-    Aabb<uint32_t> box;
+    Aabb<int32_t> box;
     box.set(coords);
     hdr.max_x = static_cast<double>(box.max(0)) * scale[0] + offset[0];
     hdr.min_x = static_cast<double>(box.min(0)) * scale[0] + offset[0];
@@ -356,7 +385,18 @@ void FileLas::readHeader(Header &hdr)
 
     file_.read(buffer, LAS_FILE_HEADER_SIZE_V10);
 
-    // Signature "LASF"
+    // Signature "LASF", compressed point data have signature "3DFZ" and
+    // otherwise the header of the decompressed LAS file
+    hdr.point_data_compressed = 0;
+    if (std::memcmp(buffer, LAS_FILE_SIGNATURE_COMPRESSED, 4) == 0)
+    {
+        hdr.point_data_compressed = 1;
+        buffer[0] = LAS_FILE_SIGNATURE_0;
+        buffer[1] = LAS_FILE_SIGNATURE_1;
+        buffer[2] = LAS_FILE_SIGNATURE_2;
+        buffer[3] = LAS_FILE_SIGNATURE_3;
+    }
+
     std::memcpy(hdr.file_signature, buffer, 4);
     if ((hdr.file_signature[0] != LAS_FILE_SIGNATURE_0) ||
         (hdr.file_signature[1] != LAS_FILE_SIGNATURE_1) ||
@@ -489,7 +529,14 @@ void FileLas::writeHeader(const Header &hdr)
     uint32_t header_size;
 
     // Signature
-    std::memcpy(buffer, hdr.file_signature, 4);
+    if (hdr.point_data_compressed)
+    {
+        std::memcpy(buffer, LAS_FILE_SIGNATURE_COMPRESSED, 4);
+    }
+    else
+    {
+        std::memcpy(buffer, hdr.file_signature, 4);
+    }
 
     // File info
     htol16(&buffer[4], hdr.file_source_id);
@@ -589,9 +636,9 @@ void FileLas::readPoint(Point &pt, const uint8_t *buffer, uint8_t fmt) const
 
     if (fmt > 5)
     {
-        pt.x = ltoh32(&buffer[0]);
-        pt.y = ltoh32(&buffer[4]);
-        pt.z = ltoh32(&buffer[8]);
+        pt.x = ltohs32(&buffer[0]);
+        pt.y = ltohs32(&buffer[4]);
+        pt.z = ltohs32(&buffer[8]);
         pt.intensity = ltoh16(&buffer[12]);
         uint32_t data14 = static_cast<uint32_t>(buffer[14]);
         pt.return_number = static_cast<uint8_t>(data14 & 15U);
@@ -609,9 +656,9 @@ void FileLas::readPoint(Point &pt, const uint8_t *buffer, uint8_t fmt) const
     }
     else
     {
-        pt.x = ltoh32(&buffer[0]);
-        pt.y = ltoh32(&buffer[4]);
-        pt.z = ltoh32(&buffer[8]);
+        pt.x = ltohs32(&buffer[0]);
+        pt.y = ltohs32(&buffer[4]);
+        pt.z = ltohs32(&buffer[8]);
         pt.intensity = ltoh16(&buffer[12]);
         uint32_t data14 = static_cast<uint32_t>(buffer[14]);
         pt.return_number = static_cast<uint8_t>(data14 & 7U);
@@ -691,9 +738,9 @@ void FileLas::writePoint(uint8_t *buffer, const Point &pt) const
 
     if (fmt > 5)
     {
-        htol32(&buffer[0], pt.x);
-        htol32(&buffer[4], pt.y);
-        htol32(&buffer[8], pt.z);
+        htol32(&buffer[0], static_cast<uint32_t>(pt.x));
+        htol32(&buffer[4], static_cast<uint32_t>(pt.y));
+        htol32(&buffer[8], static_cast<uint32_t>(pt.z));
         htol16(&buffer[12], pt.intensity);
 
         // Return Number        4 bits (bits 0 - 3)
@@ -723,9 +770,9 @@ void FileLas::writePoint(uint8_t *buffer, const Point &pt) const
     }
     else
     {
-        htol32(&buffer[0], pt.x);
-        htol32(&buffer[4], pt.y);
-        htol32(&buffer[8], pt.z);
+        htol32(&buffer[0], static_cast<uint32_t>(pt.x));
+        htol32(&buffer[4], static_cast<uint32_t>(pt.y));
+        htol32(&buffer[8], static_cast<uint32_t>(pt.z));
         htol16(&buffer[12], pt.intensity);
 
         // Return Number        3 bits (bits 0 – 2)
@@ -806,6 +853,438 @@ void FileLas::writePoint(uint8_t *buffer, const Point &pt) const
     }
 }
 
+FileLas::Columns::Columns()
+    : xyz(nullptr),
+      intensity(nullptr),
+      returnNumber(nullptr),
+      numberOfReturns(nullptr),
+      classification(nullptr),
+      userData(nullptr),
+      gpsTime(nullptr),
+      rgb(nullptr),
+      userLayer(nullptr),
+      userRgb(nullptr)
+{
+}
+
+void FileLas::readPoints(Columns &columns,
+                         const uint8_t *buffer,
+                         size_t n,
+                         const std::array<double, 3> &scale,
+                         const std::array<double, 3> &offset) const
+{
+    // Dispatch to the decoder specialized for the point format
+    switch (header.point_data_record_format)
+    {
+        case 0:
+            readPoints<0>(columns, buffer, n, scale, offset);
+            break;
+        case 1:
+            readPoints<1>(columns, buffer, n, scale, offset);
+            break;
+        case 2:
+            readPoints<2>(columns, buffer, n, scale, offset);
+            break;
+        case 3:
+            readPoints<3>(columns, buffer, n, scale, offset);
+            break;
+        case 4:
+            readPoints<4>(columns, buffer, n, scale, offset);
+            break;
+        case 5:
+            readPoints<5>(columns, buffer, n, scale, offset);
+            break;
+        case 6:
+            readPoints<6>(columns, buffer, n, scale, offset);
+            break;
+        case 7:
+            readPoints<7>(columns, buffer, n, scale, offset);
+            break;
+        case 8:
+            readPoints<8>(columns, buffer, n, scale, offset);
+            break;
+        case 9:
+            readPoints<9>(columns, buffer, n, scale, offset);
+            break;
+        case 10:
+            readPoints<10>(columns, buffer, n, scale, offset);
+            break;
+        default:
+            THROW("LAS point data record format is not supported");
+            break;
+    }
+}
+
+template <uint8_t FMT>
+void FileLas::readPoints(Columns &columns,
+                         const uint8_t *buffer,
+                         size_t n,
+                         const std::array<double, 3> &scale,
+                         const std::array<double, 3> &offset) const
+{
+    // Record layout of format FMT
+    constexpr bool legacy = FMT < 6;
+    constexpr bool hasGps = FMT == 1 || FMT > 2;
+    constexpr bool hasRgb = FMT == 2 || FMT == 3 || FMT == 5 || FMT == 7 ||
+                            FMT == 8 || FMT == 10;
+    constexpr bool hasNir = FMT == 8 || FMT == 10;
+    constexpr bool hasWave = FMT == 4 || FMT == 5 || FMT == 9 || FMT == 10;
+    constexpr size_t posGps = legacy ? 20 : 22;
+    constexpr size_t posRgb = posGps + (hasGps ? 8 : 0);
+    constexpr size_t posUser =
+        posRgb + (hasRgb ? 6 : 0) + (hasNir ? 2 : 0) + (hasWave ? 29 : 0);
+
+    const size_t size = header.point_data_record_length;
+    const bool hasUser = size > (posUser + 11);
+
+#if defined(__SSE2__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    const __m128d s = _mm_set_pd(scale[1], scale[0]);
+    const __m128d o = _mm_set_pd(offset[1], offset[0]);
+#endif
+
+    // Each column is converted in its own pass with a constant stride.
+    // The passes are repeated for blocks of records which stay in cache.
+    for (size_t from = 0; from < n; from += LAS_FILE_BLOCK_SIZE)
+    {
+        const size_t to = std::min(n, from + LAS_FILE_BLOCK_SIZE);
+        const uint8_t *block = buffer + (from * size);
+        const uint8_t *ptr;
+
+        if (columns.xyz)
+        {
+            double *xyz = columns.xyz;
+            ptr = block;
+#if defined(__SSE2__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            // Convert signed x and y pairs to doubles with SSE2
+            for (size_t i = from; i < to; i++)
+            {
+                __m128i v =
+                    _mm_loadl_epi64(reinterpret_cast<const __m128i *>(ptr));
+                __m128d d = _mm_cvtepi32_pd(v);
+                _mm_storeu_pd(&xyz[3 * i], _mm_add_pd(_mm_mul_pd(d, s), o));
+                xyz[3 * i + 2] =
+                    static_cast<double>(ltohs32(&ptr[8])) * scale[2] +
+                    offset[2];
+                ptr += size;
+            }
+#else
+            for (size_t i = from; i < to; i++)
+            {
+                xyz[3 * i + 0] =
+                    static_cast<double>(ltohs32(&ptr[0])) * scale[0] +
+                    offset[0];
+                xyz[3 * i + 1] =
+                    static_cast<double>(ltohs32(&ptr[4])) * scale[1] +
+                    offset[1];
+                xyz[3 * i + 2] =
+                    static_cast<double>(ltohs32(&ptr[8])) * scale[2] +
+                    offset[2];
+                ptr += size;
+            }
+#endif
+        }
+
+        if (columns.intensity)
+        {
+            ptr = block;
+            for (size_t i = from; i < to; i++)
+            {
+                columns.intensity[i] = ltoh16(&ptr[12]);
+                ptr += size;
+            }
+        }
+
+        if (columns.returnNumber)
+        {
+            ptr = block;
+            for (size_t i = from; i < to; i++)
+            {
+                columns.returnNumber[i] =
+                    static_cast<uint8_t>(ptr[14] & (legacy ? 7U : 15U));
+                ptr += size;
+            }
+        }
+
+        if (columns.numberOfReturns)
+        {
+            ptr = block;
+            for (size_t i = from; i < to; i++)
+            {
+                columns.numberOfReturns[i] = static_cast<uint8_t>(
+                    legacy ? ((ptr[14] >> 3) & 7U) : ((ptr[14] >> 4) & 15U));
+                ptr += size;
+            }
+        }
+
+        if (columns.classification)
+        {
+            ptr = block + (legacy ? 15 : 16);
+            for (size_t i = from; i < to; i++)
+            {
+                columns.classification[i] =
+                    static_cast<uint8_t>(legacy ? (ptr[0] & 0x1fU) : ptr[0]);
+                ptr += size;
+            }
+        }
+
+        if (columns.userData)
+        {
+            ptr = block;
+            for (size_t i = from; i < to; i++)
+            {
+                columns.userData[i] = ptr[17];
+                ptr += size;
+            }
+        }
+
+        if (columns.gpsTime)
+        {
+            ptr = block + posGps;
+            for (size_t i = from; i < to; i++)
+            {
+                columns.gpsTime[i] = hasGps ? ltohd(ptr) : 0.0;
+                ptr += size;
+            }
+        }
+
+        if (columns.rgb)
+        {
+            ptr = block + posRgb;
+            for (size_t i = from; i < to; i++)
+            {
+                columns.rgb[3 * i + 0] = hasRgb ? ltoh16(&ptr[0]) : 0;
+                columns.rgb[3 * i + 1] = hasRgb ? ltoh16(&ptr[2]) : 0;
+                columns.rgb[3 * i + 2] = hasRgb ? ltoh16(&ptr[4]) : 0;
+                ptr += size;
+            }
+        }
+
+        if (columns.userLayer)
+        {
+            ptr = block + posUser;
+            for (size_t i = from; i < to; i++)
+            {
+                columns.userLayer[i] = hasUser ? ltoh32(ptr) : 0;
+                ptr += size;
+            }
+        }
+
+        if (columns.userRgb)
+        {
+            ptr = block + posUser;
+            for (size_t i = from; i < to; i++)
+            {
+                columns.userRgb[3 * i + 0] = hasUser ? ltoh16(&ptr[4]) : 0;
+                columns.userRgb[3 * i + 1] = hasUser ? ltoh16(&ptr[6]) : 0;
+                columns.userRgb[3 * i + 2] = hasUser ? ltoh16(&ptr[8]) : 0;
+                ptr += size;
+            }
+        }
+    }
+}
+
+void FileLas::writePoints(uint8_t *buffer,
+                          const Columns &columns,
+                          size_t n,
+                          const std::array<double, 3> &scale,
+                          const std::array<double, 3> &offset) const
+{
+    // Dispatch to the encoder specialized for the point format
+    switch (header.point_data_record_format)
+    {
+        case 0:
+            writePoints<0>(buffer, columns, n, scale, offset);
+            break;
+        case 1:
+            writePoints<1>(buffer, columns, n, scale, offset);
+            break;
+        case 2:
+            writePoints<2>(buffer, columns, n, scale, offset);
+            break;
+        case 3:
+            writePoints<3>(buffer, columns, n, scale, offset);
+            break;
+        case 4:
+            writePoints<4>(buffer, columns, n, scale, offset);
+            break;
+        case 5:
+            writePoints<5>(buffer, columns, n, scale, offset);
+            break;
+        case 6:
+            writePoints<6>(buffer, columns, n, scale, offset);
+            break;
+        case 7:
+            writePoints<7>(buffer, columns, n, scale, offset);
+            break;
+        case 8:
+            writePoints<8>(buffer, columns, n, scale, offset);
+            break;
+        case 9:
+            writePoints<9>(buffer, columns, n, scale, offset);
+            break;
+        case 10:
+            writePoints<10>(buffer, columns, n, scale, offset);
+            break;
+        default:
+            THROW("LAS point data record format is not supported");
+            break;
+    }
+}
+
+template <uint8_t FMT>
+void FileLas::writePoints(uint8_t *buffer,
+                          const Columns &columns,
+                          size_t n,
+                          const std::array<double, 3> &scale,
+                          const std::array<double, 3> &offset) const
+{
+    // Record layout of format FMT
+    constexpr bool legacy = FMT < 6;
+    constexpr bool hasGps = FMT == 1 || FMT > 2;
+    constexpr bool hasRgb = FMT == 2 || FMT == 3 || FMT == 5 || FMT == 7 ||
+                            FMT == 8 || FMT == 10;
+    constexpr bool hasNir = FMT == 8 || FMT == 10;
+    constexpr bool hasWave = FMT == 4 || FMT == 5 || FMT == 9 || FMT == 10;
+    constexpr size_t posGps = legacy ? 20 : 22;
+    constexpr size_t posRgb = posGps + (hasGps ? 8 : 0);
+    constexpr size_t posUser =
+        posRgb + (hasRgb ? 6 : 0) + (hasNir ? 2 : 0) + (hasWave ? 29 : 0);
+
+    const size_t size = header.point_data_record_length;
+    const bool hasUser = size > (posUser + 11);
+
+    const double inverse[3] = {1.0 / scale[0], 1.0 / scale[1], 1.0 / scale[2]};
+
+    // Each column is converted in its own pass with a constant stride.
+    // The passes are repeated for blocks of records which stay in cache.
+    for (size_t from = 0; from < n; from += LAS_FILE_BLOCK_SIZE)
+    {
+        const size_t to = std::min(n, from + LAS_FILE_BLOCK_SIZE);
+        uint8_t *block = buffer + (from * size);
+        uint8_t *ptr;
+
+        // Fields without input column are zero
+        std::memset(block, 0, (to - from) * size);
+
+        if (columns.xyz)
+        {
+            const double *xyz = columns.xyz;
+            ptr = block;
+            for (size_t i = from; i < to; i++)
+            {
+                for (size_t k = 0; k < 3; k++)
+                {
+                    // Round half away from zero
+                    double v = (xyz[3 * i + k] - offset[k]) * inverse[k];
+                    v += (v < 0.0) ? -0.5 : 0.5;
+                    htol32(&ptr[4 * k],
+                           static_cast<uint32_t>(static_cast<int64_t>(v)));
+                }
+                ptr += size;
+            }
+        }
+
+        if (columns.intensity)
+        {
+            ptr = block;
+            for (size_t i = from; i < to; i++)
+            {
+                htol16(&ptr[12], columns.intensity[i]);
+                ptr += size;
+            }
+        }
+
+        if (columns.returnNumber)
+        {
+            ptr = block;
+            for (size_t i = from; i < to; i++)
+            {
+                ptr[14] = static_cast<uint8_t>(
+                    ptr[14] | (columns.returnNumber[i] & (legacy ? 7U : 15U)));
+                ptr += size;
+            }
+        }
+
+        if (columns.numberOfReturns)
+        {
+            ptr = block;
+            for (size_t i = from; i < to; i++)
+            {
+                uint32_t v = columns.numberOfReturns[i];
+                v = legacy ? ((v & 7U) << 3) : ((v & 15U) << 4);
+                ptr[14] = static_cast<uint8_t>(ptr[14] | v);
+                ptr += size;
+            }
+        }
+
+        if (columns.classification)
+        {
+            ptr = block + (legacy ? 15 : 16);
+            for (size_t i = from; i < to; i++)
+            {
+                ptr[0] = static_cast<uint8_t>(
+                    legacy ? (columns.classification[i] & 0x1fU)
+                           : columns.classification[i]);
+                ptr += size;
+            }
+        }
+
+        if (columns.userData)
+        {
+            ptr = block;
+            for (size_t i = from; i < to; i++)
+            {
+                ptr[17] = columns.userData[i];
+                ptr += size;
+            }
+        }
+
+        if (hasGps && columns.gpsTime)
+        {
+            ptr = block + posGps;
+            for (size_t i = from; i < to; i++)
+            {
+                htold(ptr, columns.gpsTime[i]);
+                ptr += size;
+            }
+        }
+
+        if (hasRgb && columns.rgb)
+        {
+            ptr = block + posRgb;
+            for (size_t i = from; i < to; i++)
+            {
+                htol16(&ptr[0], columns.rgb[3 * i + 0]);
+                htol16(&ptr[2], columns.rgb[3 * i + 1]);
+                htol16(&ptr[4], columns.rgb[3 * i + 2]);
+                ptr += size;
+            }
+        }
+
+        if (hasUser && columns.userLayer)
+        {
+            ptr = block + posUser;
+            for (size_t i = from; i < to; i++)
+            {
+                htol32(ptr, columns.userLayer[i]);
+                ptr += size;
+            }
+        }
+
+        if (hasUser && columns.userRgb)
+        {
+            ptr = block + posUser;
+            for (size_t i = from; i < to; i++)
+            {
+                htol16(&ptr[4], columns.userRgb[3 * i + 0]);
+                htol16(&ptr[6], columns.userRgb[3 * i + 1]);
+                htol16(&ptr[8], columns.userRgb[3 * i + 2]);
+                ptr += size;
+            }
+        }
+    }
+}
+
 void FileLas::transform(double &x, double &y, double &z, const Point &pt) const
 {
     x = (static_cast<double>(pt.x) * header.x_scale_factor) + header.x_offset;
@@ -818,9 +1297,9 @@ void FileLas::transform(double &x,
                         double &z,
                         const uint8_t *buffer) const
 {
-    double px = static_cast<double>(ltoh32(&buffer[0]));
-    double py = static_cast<double>(ltoh32(&buffer[4]));
-    double pz = static_cast<double>(ltoh32(&buffer[8]));
+    double px = static_cast<double>(ltohs32(&buffer[0]));
+    double py = static_cast<double>(ltohs32(&buffer[4]));
+    double pz = static_cast<double>(ltohs32(&buffer[8]));
     x = (px * header.x_scale_factor) + header.x_offset;
     y = (py * header.y_scale_factor) + header.y_offset;
     z = (pz * header.z_scale_factor) + header.z_offset;
@@ -902,6 +1381,7 @@ Json &FileLas::Header::write(Json &out) const
 
     out["point_data_record_format"] = point_data_record_format;
     out["point_data_record_length"] = point_data_record_length;
+    out["point_data_compressed"] = point_data_compressed;
     out["point_data_record_user_length"] = pointDataRecordLengthUser();
     out["number_of_point_records"] = number_of_point_records;
 
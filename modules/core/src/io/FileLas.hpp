@@ -24,6 +24,7 @@
 
 #include <File.hpp>
 #include <Json.hpp>
+#include <array>
 #include <string>
 #include <vector>
 
@@ -87,14 +88,24 @@ public:
         uint64_t number_of_points_by_return[15];
         // End of 1.4 (375 bytes)
 
+        // 3D Forest, stored as file signature "3DFZ" instead of "LASF"
+        uint8_t point_data_compressed;
+
         size_t versionHeaderSize() const;
         size_t pointDataRecordLengthFormat() const;
         size_t pointDataRecordLength3dForest() const;
         size_t pointDataRecordLengthUser() const;
         uint64_t pointDataSize() const;
         std::string dateCreated() const;
+        bool hasGpsTime() const;
         bool hasRgb() const;
+        bool hasNir() const;
+        bool hasWave() const;
 
+        void set(uint8_t format,
+                 const std::array<double, 3> &scale,
+                 const std::array<double, 3> &offset,
+                 uint8_t versionMinor);
         void setGeneratingSoftware();
         void addOffsetPointData(uint64_t increment);
         void addOffsetWdpr(uint64_t increment);
@@ -108,9 +119,9 @@ public:
     struct Point
     {
         // Format 0 to 10
-        uint32_t x;
-        uint32_t y; // 1*8
-        uint32_t z;
+        int32_t x;
+        int32_t y; // 1*8
+        int32_t z;
         uint16_t intensity; // Optional
 
         // Format 0 to 10
@@ -164,6 +175,28 @@ public:
         Json &write(Json &out) const;
     };
 
+    /** LAS Point Columns.
+        Caller-provided arrays for bulk conversion of point records.
+        Each array must hold n values (n * 3 for xyz and colors).
+        Columns which are nullptr are skipped when reading and written
+        as zero.
+    */
+    struct Columns
+    {
+        double *xyz;              // [x0, y0, z0, x1, y1, ...]
+        uint16_t *intensity;      // [i0, i1, ...]
+        uint8_t *returnNumber;    // [n0, n1, ...]
+        uint8_t *numberOfReturns; // [n0, n1, ...]
+        uint8_t *classification;  // [c0, c1, ...]
+        uint8_t *userData;        // [u0, u1, ...]
+        double *gpsTime;          // [t0, t1, ...], 0 when not present
+        uint16_t *rgb;            // [r0, g0, b0, r1, ...], 0 when not present
+        uint32_t *userLayer;      // [l0, l1, ...], 0 when not present
+        uint16_t *userRgb;        // [r0, g0, b0, r1, ...], 0 when not present
+
+        Columns();
+    };
+
     Header header;
 
     FileLas();
@@ -193,6 +226,17 @@ public:
     void writePoint(const Point &pt);
     void writePoint(uint8_t *buffer, const Point &pt) const;
 
+    void readPoints(Columns &columns,
+                    const uint8_t *buffer,
+                    size_t n,
+                    const std::array<double, 3> &scale = {1, 1, 1},
+                    const std::array<double, 3> &offset = {0, 0, 0}) const;
+    void writePoints(uint8_t *buffer,
+                     const Columns &columns,
+                     size_t n,
+                     const std::array<double, 3> &scale = {1, 1, 1},
+                     const std::array<double, 3> &offset = {0, 0, 0}) const;
+
     void transform(double &x, double &y, double &z, const Point &pt) const;
     void transform(double &x,
                    double &y,
@@ -208,6 +252,20 @@ protected:
     void readHeader(Header &hdr);
     void writeHeader(const Header &hdr);
     void readPoint(uint8_t *buffer);
+
+    template <uint8_t FMT>
+    void readPoints(Columns &columns,
+                    const uint8_t *buffer,
+                    size_t n,
+                    const std::array<double, 3> &scale,
+                    const std::array<double, 3> &offset) const;
+
+    template <uint8_t FMT>
+    void writePoints(uint8_t *buffer,
+                     const Columns &columns,
+                     size_t n,
+                     const std::array<double, 3> &scale,
+                     const std::array<double, 3> &offset) const;
 };
 
 std::ostream &operator<<(std::ostream &os, const FileLas::Header &obj);
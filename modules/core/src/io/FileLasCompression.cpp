@@ -0,0 +1,443 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/** @file FileLasCompression.cpp */
+
+#include <Endian.hpp>
+#include <Error.hpp>
+#include <FileLasCompression.hpp>
+#include <limits>
+
+#define FILE_LAS_COMPRESSION_USER_SIZE 12
+
+static uint64_t FileLasCompressionLoad(const uint8_t *ptr, size_t size)
+{
+    switch (size)
+    {
+        case 1:
+            return ptr[0];
+        case 2:
+            return ltoh16(ptr);
+        case 4:
+            return ltoh32(ptr);
+        default:
+            return ltoh64(ptr);
+    }
+}
+
+static void FileLasCompressionStore(uint8_t *ptr, uint8_t value)
+{
+    ptr[0] = value;
+}
+
+static void FileLasCompressionStore(uint8_t *ptr, uint16_t value)
+{
+    htol16(ptr, value);
+}
+
+static void FileLasCompressionStore(uint8_t *ptr, uint32_t value)
+{
+    htol32(ptr, value);
+}
+
+static void FileLasCompressionStore(uint8_t *ptr, uint64_t value)
+{
+    htol64(ptr, value);
+}
+
+/** Unpack one field of n records, return the end of the field data. */
+template <typename T>
+static const uint8_t *FileLasCompressionUnpack(uint8_t *records,
+                                               size_t recordLength,
+                                               const uint8_t *data,
+                                               const uint8_t *end,
+                                               size_t n)
+{
+    // Bit width
+    if (data >= end)
+    {
+        THROW("Invalid compressed point data");
+    }
+
+    size_t bits = *data++;
+    if (bits > sizeof(T) * 8)
+    {
+        THROW("Invalid compressed point data");
+    }
+
+    // Minimum value
+    uint64_t base = 0;
+    size_t shift = 0;
+    uint8_t byte;
+    do
+    {
+        if (data >= end || shift > 63)
+        {
+            THROW("Invalid compressed point data");
+        }
+        byte = *data++;
+        base |= static_cast<uint64_t>(byte & 0x7fU) << shift;
+        shift += 7;
+    } while (byte & 0x80U);
+
+    size_t nbyte = ((n * bits) + 7) / 8;
+    if (static_cast<size_t>(end - data) < nbyte)
+    {
+        THROW("Invalid compressed point data");
+    }
+
+    // Constant
+    if (bits == 0)
+    {
+        T value = static_cast<T>(base);
+        for (size_t i = 0; i < n; i++)
+        {
+            FileLasCompressionStore(records + (i * recordLength), value);
+        }
+
+        return data;
+    }
+
+    // Deltas which can be read by one 64-bit load and one extra byte
+    uint64_t mask = std::numeric_limits<uint64_t>::max();
+    if (bits < 64)
+    {
+        mask = (1ULL << bits) - 1ULL;
+    }
+
+    size_t i = 0;
+    if (nbyte >= 9)
+    {
+        size_t nfast = (((nbyte - 9) * 8) + 7) / bits + 1;
+        if (nfast > n)
+        {
+            nfast = n;
+        }
+
+        for (; i < nfast; i++)
+        {
+            size_t pos = i * bits;
+            const uint8_t *ptr = data + (pos >> 3);
+            size_t s = pos & 7U;
+            uint64_t value = ltoh64(ptr) >> s;
+            if (s + bits > 64)
+            {
+                value |= static_cast<uint64_t>(ptr[8]) << (64 - s);
+            }
+
+            FileLasCompressionStore(records + (i * recordLength),
+                                    static_cast<T>(base + (value & mask)));
+        }
+    }
+
+    // Remaining deltas at the end of data
+    for (; i < n; i++)
+    {
+        size_t pos = i * bits;
+        size_t idx = pos >> 3;
+        size_t s = pos & 7U;
+        size_t count = 8 - s;
+        uint64_t value = static_cast<uint64_t>(data[idx++]) >> s;
+        while (count < bits)
+        {
+            value |= static_cast<uint64_t>(data[idx++]) << count;
+            count += 8;
+        }
+
+        FileLasCompressionStore(records + (i * recordLength),
+                                static_cast<T>(base + (value & mask)));
+    }
+
+    return data + nbyte;
+}
+
+FileLasCompression::FileLasCompression() : recordLength_(0)
+{
+}
+
+FileLasCompression::~FileLasCompression()
+{
+}
+
+void FileLasCompression::addField(size_t &offset, size_t size)
+{
+    fields_.push_back({offset, size});
+    offset += size;
+}
+
+void FileLasCompression::setFormat(const FileLas::Header &header)
+{
+    fields_.clear();
+    recordLength_ = header.point_data_record_length;
+
+    size_t offset = 0;
+
+    // Coordinates and intensity
+    addField(offset, 4);
+    addField(offset, 4);
+    addField(offset, 4);
+    addField(offset, 2);
+
+    // Returns, flags, classification, user data, scan angle and source
+    addField(offset, 1);
+    addField(offset, 1);
+    addField(offset, 1);
+    addField(offset, 1);
+    if (header.point_data_record_format > 5)
+    {
+        addField(offset, 2);
+    }
+    addField(offset, 2);
+
+    if (header.hasGpsTime())
+    {
+        addField(offset, 8);
+    }
+
+    if (header.hasRgb())
+    {
+        addField(offset, 2);
+        addField(offset, 2);
+        addField(offset, 2);
+    }
+
+    if (header.hasNir())
+    {
+        addField(offset, 2);
+    }
+
+    if (header.hasWave())
+    {
+        addField(offset, 1);
+        addField(offset, 8);
+        addField(offset, 4);
+        addField(offset, 4);
+        addField(offset, 4);
+        addField(offset, 4);
+        addField(offset, 4);
+    }
+
+    // User layer, color and intensity
+    if (recordLength_ >= offset + FILE_LAS_COMPRESSION_USER_SIZE)
+    {
+        addField(offset, 4);
+        addField(offset, 2);
+        addField(offset, 2);
+        addField(offset, 2);
+        addField(offset, 2);
+    }
+
+    // Other extra bytes
+    while (offset < recordLength_)
+    {
+        addField(offset, 1);
+    }
+
+    if (offset != recordLength_)
+    {
+        THROW("Invalid point data record length for compression");
+    }
+}
+
+void FileLasCompression::compress(std::vector<uint8_t> &out,
+                                  const uint8_t *records,
+                                  size_t n) const
+{
+    std::vector<uint64_t> values(n);
+
+    for (const Field &field : fields_)
+    {
+        // Frame of reference
+        uint64_t min = std::numeric_limits<uint64_t>::max();
+        uint64_t max = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            const uint8_t *ptr = records + (i * recordLength_) + field.offset;
+            values[i] = FileLasCompressionLoad(ptr, field.size);
+            if (values[i] < min)
+            {
+                min = values[i];
+            }
+            if (values[i] > max)
+            {
+                max = values[i];
+            }
+        }
+
+        if (n == 0)
+        {
+            min = 0;
+        }
+
+        size_t bits = 0;
+        uint64_t range = max - min;
+        while (bits < 64 && (range >> bits) != 0)
+        {
+            bits++;
+        }
+
+        // Field header with bit width and minimum value
+        out.push_back(static_cast<uint8_t>(bits));
+
+        uint64_t base = min;
+        do
+        {
+            uint8_t byte = static_cast<uint8_t>(base & 0x7fU);
+            base = base >> 7;
+            if (base)
+            {
+                byte = static_cast<uint8_t>(byte | 0x80U);
+            }
+            out.push_back(byte);
+        } while (base);
+
+        // Bit-packed deltas
+        size_t start = out.size();
+        out.resize(start + (((n * bits) + 7) / 8));
+        uint8_t *ptr = out.data() + start;
+
+        uint64_t word = 0;
+        size_t used = 0;
+        for (size_t i = 0; i < n && bits > 0; i++)
+        {
+            uint64_t value = values[i] - min;
+            word |= value << used;
+            if (used + bits >= 64)
+            {
+                htol64(ptr, word);
+                ptr += 8;
+                word = (used > 0) ? (value >> (64 - used)) : 0;
+                used = used + bits - 64;
+            }
+            else
+            {
+                used += bits;
+            }
+        }
+
+        while (used > 0)
+        {
+            *ptr++ = static_cast<uint8_t>(word);
+            word = word >> 8;
+            used = (used > 8) ? (used - 8) : 0;
+        }
+    }
+}
+
+void FileLasCompression::decompress(uint8_t *records,
+                                    const uint8_t *data,
+                                    size_t nbyte,
+                                    size_t n) const
+{
+    const uint8_t *end = data + nbyte;
+
+    for (const Field &field : fields_)
+    {
+        uint8_t *ptr = records + field.offset;
+
+        switch (field.size)
+        {
+            case 1:
+                data = FileLasCompressionUnpack<uint8_t>(ptr,
+                                                         recordLength_,
+                                                         data,
+                                                         end,
+                                                         n);
+                break;
+            case 2:
+                data = FileLasCompressionUnpack<uint16_t>(ptr,
+                                                          recordLength_,
+                                                          data,
+                                                          end,
+                                                          n);
+                break;
+            case 4:
+                data = FileLasCompressionUnpack<uint32_t>(ptr,
+                                                          recordLength_,
+                                                          data,
+                                                          end,
+                                                          n);
+                break;
+            default:
+                data = FileLasCompressionUnpack<uint64_t>(ptr,
+                                                          recordLength_,
+                                                          data,
+                                                          end,
+                                                          n);
+                break;
+        }
+    }
+
+    if (data != end)
+    {
+        THROW("Invalid compressed point data");
+    }
+}
+
+void FileLasCompression::readNode(uint8_t *records,
+                                  FileLas &las,
+                                  const std::string &indexPath,
+                                  const FileIndex::Node &node)
+{
+    if (node.size == 0)
+    {
+        return;
+    }
+
+    // Leaves of this node
+    FileIndex index;
+    index.read(indexPath, node.offset);
+
+    // Compressed blocks of all leaves
+    std::vector<uint8_t> buffer;
+    buffer.resize(static_cast<size_t>(node.dataSize));
+    las.seek(las.header.offset_to_point_data + node.dataOffset);
+    las.file().read(buffer.data(), node.dataSize);
+
+    // Decompress
+    FileLasCompression compression;
+    compression.setFormat(las.header);
+    size_t recordLength = las.header.point_data_record_length;
+    uint64_t dataEnd = node.dataOffset + node.dataSize;
+
+    for (size_t i = 0; i < index.size(); i++)
+    {
+        const FileIndex::Node *leaf = index.at(i);
+        if (leaf->size == 0 || !index.isLeaf(leaf))
+        {
+            continue;
+        }
+
+        if (leaf->dataOffset < node.dataOffset ||
+            leaf->dataOffset + leaf->dataSize > dataEnd ||
+            leaf->from + leaf->size > node.size)
+        {
+            THROW("Invalid compressed point data in '" + las.file().path() +
+                  "'");
+        }
+
+        size_t from = static_cast<size_t>(leaf->from);
+        size_t offset = static_cast<size_t>(leaf->dataOffset - node.dataOffset);
+        compression.decompress(records + (from * recordLength),
+                               buffer.data() + offset,
+                               static_cast<size_t>(leaf->dataSize),
+                               static_cast<size_t>(leaf->size));
+    }
+}
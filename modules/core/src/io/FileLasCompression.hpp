@@ -0,0 +1,74 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/** @file FileLasCompression.hpp */
+
+#ifndef FILE_LAS_COMPRESSION_HPP
+#define FILE_LAS_COMPRESSION_HPP
+
+#include <FileIndex.hpp>
+#include <FileLas.hpp>
+#include <string>
+#include <vector>
+
+/** File LAS Compression.
+    Lossless compression of LAS point data records in indexed files.
+    Points of each leaf of the node index are stored as one block.
+    Every record field is delta-coded against its minimum value in the
+    block and bit-packed with the width of the largest delta.
+    Offsets and sizes of the blocks are stored in the index.
+*/
+class FileLasCompression
+{
+public:
+    FileLasCompression();
+    ~FileLasCompression();
+
+    void setFormat(const FileLas::Header &header);
+
+    void compress(std::vector<uint8_t> &out,
+                  const uint8_t *records,
+                  size_t n) const;
+
+    void decompress(uint8_t *records,
+                    const uint8_t *data,
+                    size_t nbyte,
+                    size_t n) const;
+
+    static void readNode(uint8_t *records,
+                         FileLas &las,
+                         const std::string &indexPath,
+                         const FileIndex::Node &node);
+
+protected:
+    /** File LAS Compression Field. */
+    struct Field
+    {
+        size_t offset;
+        size_t size;
+    };
+
+    std::vector<Field> fields_;
+    size_t recordLength_;
+
+    void addField(size_t &offset, size_t size);
+};
+
+#endif /* FILE_LAS_COMPRESSION_HPP */
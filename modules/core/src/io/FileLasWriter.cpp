@@ -0,0 +1,215 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file FileLasWriter.cpp */
+
+#include <Error.hpp>
+#include <FileLasWriter.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#define FILE_LAS_WRITER_BUFFER_SIZE (4 * 1024 * 1024)
+
+FileLasWriter::FileLasWriter() : bufferSize_(0), open_(false)
+{
+}
+
+FileLasWriter::~FileLasWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+        // Ignore
+    }
+}
+
+void FileLasWriter::create(const std::string &path,
+                           uint8_t format,
+                           const std::array<double, 3> &scale,
+                           const std::array<double, 3> &offset,
+                           uint8_t versionMinor)
+{
+    close();
+
+    if (format > 10)
+    {
+        THROW("LAS point data record format is not supported");
+    }
+
+    las_.create(path);
+    las_.header.set(format, scale, offset, versionMinor);
+
+    // Placeholder header, rewritten by close()
+    las_.writeHeader();
+
+    buffer_.resize(FILE_LAS_WRITER_BUFFER_SIZE);
+    bufferSize_ = 0;
+
+    min_.fill(std::numeric_limits<double>::max());
+    max_.fill(std::numeric_limits<double>::lowest());
+
+    open_ = true;
+}
+
+void FileLasWriter::write(const FileLas::Columns &columns, size_t n)
+{
+    if (!open_)
+    {
+        THROW("LAS writer is not open");
+    }
+
+    FileLas::Header &hdr = las_.header;
+    const std::array<double, 3> scale = {hdr.x_scale_factor,
+                                         hdr.y_scale_factor,
+                                         hdr.z_scale_factor};
+    const std::array<double, 3> offset = {hdr.x_offset,
+                                          hdr.y_offset,
+                                          hdr.z_offset};
+    const size_t size = hdr.point_data_record_length;
+    const size_t capacity = buffer_.size() / size;
+
+    // Statistics
+    if (columns.xyz)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            for (size_t k = 0; k < 3; k++)
+            {
+                // Extents of stored values after quantization
+                double v = (columns.xyz[3 * i + k] - offset[k]) / scale[k];
+                v = std::round(v) * scale[k] + offset[k];
+                min_[k] = std::min(min_[k], v);
+                max_[k] = std::max(max_[k], v);
+            }
+        }
+    }
+    else if (n > 0)
+    {
+        for (size_t k = 0; k < 3; k++)
+        {
+            min_[k] = std::min(min_[k], offset[k]);
+            max_[k] = std::max(max_[k], offset[k]);
+        }
+    }
+
+    if (columns.returnNumber)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            uint8_t r = columns.returnNumber[i];
+            if (r > 0 && r < 16)
+            {
+                hdr.number_of_points_by_return[r - 1]++;
+            }
+        }
+    }
+
+    hdr.number_of_point_records += n;
+
+    // Encode to buffer in parts
+    size_t from = 0;
+    while (from < n)
+    {
+        size_t count = std::min(n - from, capacity - bufferSize_);
+
+        FileLas::Columns part;
+        part.xyz = columns.xyz ? columns.xyz + 3 * from : nullptr;
+        part.intensity = columns.intensity ? columns.intensity + from : nullptr;
+        part.returnNumber =
+            columns.returnNumber ? columns.returnNumber + from : nullptr;
+        part.numberOfReturns =
+            columns.numberOfReturns ? columns.numberOfReturns + from : nullptr;
+        part.classification =
+            columns.classification ? columns.classification + from : nullptr;
+        part.userData = columns.userData ? columns.userData + from : nullptr;
+        part.gpsTime = columns.gpsTime ? columns.gpsTime + from : nullptr;
+        part.rgb = columns.rgb ? columns.rgb + 3 * from : nullptr;
+        part.userLayer = columns.userLayer ? columns.userLayer + from : nullptr;
+        part.userRgb = columns.userRgb ? columns.userRgb + 3 * from : nullptr;
+
+        las_.writePoints(buffer_.data() + bufferSize_ * size,
+                         part,
+                         count,
+                         scale,
+                         offset);
+
+        bufferSize_ += count;
+        from += count;
+
+        if (bufferSize_ == capacity)
+        {
+            flush();
+        }
+    }
+}
+
+void FileLasWriter::close()
+{
+    if (!open_)
+    {
+        return;
+    }
+
+    open_ = false;
+
+    flush();
+
+    // Update header
+    FileLas::Header &hdr = las_.header;
+
+    if (hdr.number_of_point_records > 0)
+    {
+        hdr.min_x = min_[0];
+        hdr.min_y = min_[1];
+        hdr.min_z = min_[2];
+        hdr.max_x = max_[0];
+        hdr.max_y = max_[1];
+        hdr.max_z = max_[2];
+    }
+
+    uint64_t maxPoints = std::numeric_limits<uint32_t>::max();
+    hdr.legacy_number_of_point_records = static_cast<uint32_t>(
+        std::min(hdr.number_of_point_records, maxPoints));
+    for (size_t i = 0; i < 5; i++)
+    {
+        hdr.legacy_number_of_points_by_return[i] = static_cast<uint32_t>(
+            std::min(hdr.number_of_points_by_return[i], maxPoints));
+    }
+
+    las_.seekHeader();
+    las_.writeHeader();
+    las_.close();
+
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+}
+
+void FileLasWriter::flush()
+{
+    if (bufferSize_ > 0)
+    {
+        las_.file().write(buffer_.data(),
+                          bufferSize_ * las_.header.point_data_record_length);
+        bufferSize_ = 0;
+    }
+}
@@ -0,0 +1,62 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file FileLasWriter.hpp */
+
+#ifndef FILE_LAS_WRITER_HPP
+#define FILE_LAS_WRITER_HPP
+
+#include <FileLas.hpp>
+#include <array>
+#include <string>
+#include <vector>
+
+/** LAS (LASer) File Writer.
+    Streams columns of points to a new LAS file. Point counts and extents
+    in the header are updated when the file is closed.
+*/
+class FileLasWriter
+{
+public:
+    FileLasWriter();
+    ~FileLasWriter();
+
+    void create(const std::string &path,
+                uint8_t format = 6,
+                const std::array<double, 3> &scale = {1, 1, 1},
+                const std::array<double, 3> &offset = {0, 0, 0},
+                uint8_t versionMinor = 4);
+    void write(const FileLas::Columns &columns, size_t n);
+    void close();
+
+    bool isOpen() const { return open_; }
+    const FileLas::Header &header() const { return las_.header; }
+
+protected:
+    FileLas las_;
+    std::vector<uint8_t> buffer_;
+    size_t bufferSize_;
+    std::array<double, 3> min_;
+    std::array<double, 3> max_;
+    bool open_;
+
+    void flush();
+};
+
+#endif /* FILE_LAS_WRITER_HPP */
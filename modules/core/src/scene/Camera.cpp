@@ -21,10 +21,58 @@
 
 #include <Camera.hpp>
 
-Camera::Camera() : fov(60.0F)
+Camera::Camera() : fov(60.0F), width(1920), height(1080), perspective(true)
 {
 }
 
 Camera::~Camera()
 {
 }
+
+void Camera::read(const Json &in)
+{
+    eye.read(in["eye"]);
+    center.read(in["center"]);
+
+    if (in.contains("up"))
+    {
+        up.read(in["up"]);
+    }
+    else
+    {
+        up.set(0.0F, 0.0F, 1.0F);
+    }
+
+    if (in.contains("fov"))
+    {
+        fov = static_cast<float>(in["fov"].number());
+    }
+
+    if (in.contains("width"))
+    {
+        width = static_cast<size_t>(in["width"].number());
+    }
+
+    if (in.contains("height"))
+    {
+        height = static_cast<size_t>(in["height"].number());
+    }
+
+    if (in.contains("perspective"))
+    {
+        perspective = in["perspective"].isTrue();
+    }
+}
+
+Json &Camera::write(Json &out) const
+{
+    eye.write(out["eye"]);
+    center.write(out["center"]);
+    up.write(out["up"]);
+    out["fov"] = fov;
+    out["width"] = width;
+    out["height"] = height;
+    out["perspective"] = perspective;
+
+    return out;
+}
@@ -32,10 +32,16 @@ public:
     Vector3<float> eye;
     Vector3<float> center;
     Vector3<float> up;
-    float fov;
+    float fov;        /**< Vertical field of view in degrees. */
+    size_t width;     /**< Viewport width in pixels. */
+    size_t height;    /**< Viewport height in pixels. */
+    bool perspective; /**< Perspective or orthographic projection. */
 
     Camera();
     ~Camera();
+
+    void read(const Json &in);
+    Json &write(Json &out) const;
 };
 
 #endif /* CAMERA_HPP */
@@ -30,9 +30,13 @@ static const char *EDITOR_BASE_KEY_SETTINGS = "settings";
 static const char *EDITOR_BASE_KEY_CLASSIFICATION = "classifications";
 // static const char *EDITOR_BASE_KEY_CLIP_FILTER = "clipFilter";
 
-EditorBase::EditorBase() : working_(this)
+EditorBase::EditorBase()
+    : viewportActive_(0),
+      working_(this, &tileStore_, &loader_),
+      loader_(this, &tileStore_)
 {
     close();
+    tileStore_.setBudget(settings_.cache().size());
     setNumberOfViewports(1);
 }
 
@@ -53,11 +57,14 @@ void EditorBase::close()
     boundary_.clear();
     boundaryView_.clear();
 
+    loader_.cancel();
+    loader_.finish();
     for (auto &it : viewports_)
     {
         it->clear();
     }
     working_.clear();
+    tileStore_.clear();
 
     unsavedChanges_ = false;
 }
@@ -113,6 +120,7 @@ void EditorBase::open(const std::string &path)
         {
             settings_.read(in[EDITOR_BASE_KEY_SETTINGS]);
         }
+        tileStore_.setBudget(settings_.cache().size());
 
         // Classifications
         if (in.contains(EDITOR_BASE_KEY_CLASSIFICATION))
@@ -182,21 +190,21 @@ void EditorBase::addFile(const std::string &path, bool center)
         ds->read(path, path_);
         dataSets_.push_back(ds);
 
+        Vector3<double> translation;
         if (center)
         {
             Vector3<double> c1 = boundary_.getCenter();
             Vector3<double> c2 = ds->boundaryFile.getCenter();
             c1[2] = boundary_.min(2);
             c2[2] = ds->boundaryFile.min(2);
-            ds->translation = c1 - c2;
-            ds->updateBoundary();
+            translation = c1 - c2;
         }
         else
         {
             Vector3<double> s = 1.0 / ds->scalingFile;
-            ds->translation = ds->translationFile * s;
-            ds->updateBoundary();
+            translation = ds->translationFile * s;
         }
+        setTranslationDataSet(dataSets_.size() - 1, translation);
     }
     catch (std::exception &e)
     {
@@ -252,9 +260,38 @@ void EditorBase::applyFilters(EditorTile *tile)
     }
 }
 
+bool EditorBase::hasFilterEnabled() const
+{
+    for (auto &it : filters_)
+    {
+        if (it->isFilterEnabled())
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void EditorBase::setVisibleDataSet(size_t i, bool visible)
 {
     dataSets_[i]->visible = visible;
+    resetLod();
+    unsavedChanges_ = true;
+}
+
+void EditorBase::setTranslationDataSet(size_t i,
+                                       const Vector3<double> &translation)
+{
+    // Resident tiles are not modified, the translation is applied
+    // when tiles are rendered or queried
+    dataSets_[i]->translation = translation;
+    dataSets_[i]->updateBoundary();
+    updateBoundary();
+
+    // Clipped flags of the cached LOD cut depend on the translation
+    resetLod();
+    tileViewClear(EditorTile::filterMask(EditorTile::FILTER_CLIP));
     unsavedChanges_ = true;
 }
 
@@ -275,6 +312,7 @@ void EditorBase::setClipFilter(const ClipFilter &clipFilter)
 {
     clipFilter_ = clipFilter;
     clipFilter_.boxView.setPercent(boundaryView_, boundary_, clipFilter_.box);
+    resetLod();
 
     // unsavedChanges_ = true;
 }
@@ -292,6 +330,13 @@ void EditorBase::setSettingsView(const EditorSettings::View &settings)
     unsavedChanges_ = true;
 }
 
+void EditorBase::setSettingsCache(const EditorSettings::Cache &settings)
+{
+    settings_.setCache(settings);
+    tileStore_.setBudget(settings_.cache().size());
+    unsavedChanges_ = true;
+}
+
 void EditorBase::select(std::vector<FileIndex::Selection> &selected)
 {
     Aabb<double> box = selection();
@@ -300,7 +345,10 @@ void EditorBase::select(std::vector<FileIndex::Selection> &selected)
     {
         if (it->visible)
         {
-            it->index.selectNodes(selected, box, it->id);
+            // Index is in data set coordinates
+            Aabb<double> boxDataSet = box;
+            boxDataSet.translate(-it->translation);
+            it->index.selectNodes(selected, boxDataSet, it->id);
         }
     }
 }
@@ -322,7 +370,7 @@ void EditorBase::setNumberOfViewports(size_t n)
     while (i < n)
     {
         std::shared_ptr<EditorCache> viewport =
-            std::make_shared<EditorCache>(this);
+            std::make_shared<EditorCache>(this, &tileStore_, &loader_);
         viewports_.push_back(viewport);
         i++;
     }
@@ -334,13 +382,61 @@ void EditorBase::setNumberOfViewports(size_t n)
     }
 }
 
+void EditorBase::setNumberOfLoaderThreads(size_t n)
+{
+    loader_.setNumberOfThreads(n);
+    loader_.finish();
+}
+
+void EditorBase::setLoaderCallback(const EditorLoader::Callback &callback)
+{
+    loader_.setCallback(callback);
+}
+
+void EditorBase::cancelLoader()
+{
+    loader_.cancel();
+}
+
 void EditorBase::updateCamera(size_t viewport, const Camera &camera)
 {
-    viewports_[viewport]->updateCamera(camera);
+    // Tiles of the new view are queued in new order
+    loader_.clearQueue();
+
+    // The point budget is shared by viewports in proportion to their area,
+    // viewports without camera are expected to have the same area
+    double area = static_cast<double>(camera.width * camera.height);
+    double areaTotal = 0;
+    for (size_t i = 0; i < viewports_.size(); i++)
+    {
+        if (i != viewport && viewports_[i]->hasCamera())
+        {
+            const Camera &c = viewports_[i]->camera();
+            areaTotal += static_cast<double>(c.width * c.height);
+        }
+        else
+        {
+            areaTotal += area;
+        }
+    }
+
+    double budget = static_cast<double>(settings_.view().pointBudget());
+    if (areaTotal > 0.0)
+    {
+        budget = budget * area / areaTotal;
+    }
+
+    viewports_[viewport]->updateCamera(camera, static_cast<size_t>(budget));
+    viewportActive_ = viewport;
 }
 
-void EditorBase::tileViewClear()
+void EditorBase::tileViewClear(uint32_t filters)
 {
+    // Tiles filtered with previous settings are filtered again
+    loader_.cancel();
+    loader_.finish();
+    tileStore_.reload(filters);
+
     for (auto &it : viewports_)
     {
         it->reload();
@@ -351,9 +447,13 @@ bool EditorBase::loadView()
 {
     bool rval = true;
 
-    for (auto &it : viewports_)
+    loader_.finish();
+
+    // Tiles of the viewport with the last camera update are queued first
+    for (size_t i = 0; i < viewports_.size(); i++)
     {
-        if (!it->loadStep())
+        size_t v = (viewportActive_ + i) % viewports_.size();
+        if (!viewports_[v]->loadStep())
         {
             rval = false;
         }
@@ -387,6 +487,8 @@ void EditorBase::updateBoundary()
             boundaryView_.extend(it->boundaryView);
         }
     }
+
+    resetLod();
 }
 
 void EditorBase::resetRendering()
@@ -396,3 +498,11 @@ void EditorBase::resetRendering()
         it->resetRendering();
     }
 }
+
+void EditorBase::resetLod()
+{
+    for (auto &it : viewports_)
+    {
+        it->resetLod();
+    }
+}
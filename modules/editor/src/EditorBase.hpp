@@ -28,6 +28,7 @@
 #include <EditorDataSet.hpp>
 #include <EditorFilter.hpp>
 #include <EditorLayers.hpp>
+#include <EditorLoader.hpp>
 #include <EditorSettings.hpp>
 
 /** Editor Base. */
@@ -48,11 +49,13 @@ public:
 
     void addFilter(EditorFilter *filter);
     void applyFilters(EditorTile *tile);
+    bool hasFilterEnabled() const;
 
     // Data sets
     size_t dataSetSize() const { return dataSets_.size(); }
     const EditorDataSet &dataSet(size_t i) const { return *dataSets_[i]; }
     void setVisibleDataSet(size_t i, bool visible);
+    void setTranslationDataSet(size_t i, const Vector3<double> &translation);
 
     // Layers
     const EditorLayers &layers() const { return layers_; }
@@ -73,6 +76,7 @@ public:
     // Settings
     const EditorSettings &settings() const { return settings_; }
     void setSettingsView(const EditorSettings::View &settings);
+    void setSettingsCache(const EditorSettings::Cache &settings);
 
     // Boundary
     const Aabb<double> &boundary() const { return boundary_; }
@@ -80,15 +84,15 @@ public:
 
     void select(std::vector<FileIndex::Selection> &selected);
     Aabb<double> selection() const;
-    EditorTile *tile(size_t dataset, size_t index)
+    EditorTile *tile(size_t dataset, size_t index, uint32_t columns = 0)
     {
-        return working_.tile(dataset, index);
+        return working_.tile(dataset, index, columns);
     }
 
     void setNumberOfViewports(size_t n);
     void updateCamera(size_t viewport, const Camera &camera);
     bool loadView();
-    void tileViewClear();
+    void tileViewClear(uint32_t filters = EditorTile::filterMaskAll());
     size_t tileViewSize(size_t viewport) const
     {
         return viewports_[viewport]->tileSize();
@@ -97,6 +101,20 @@ public:
     {
         return viewports_[viewport]->tile(index);
     }
+    void setNumberOfLoaderThreads(size_t n);
+    void setLoaderCallback(const EditorLoader::Callback &callback);
+    size_t numberOfLoaderThreads() const { return loader_.numberOfThreads(); }
+    void cancelLoader();
+    EditorCache::Frame &tileViewFrame(size_t viewport, size_t index)
+    {
+        return viewports_[viewport]->frame(index);
+    }
+    std::shared_ptr<EditorCache::Snapshot> tileViewSnapshot(
+        size_t viewport) const
+    {
+        return viewports_[viewport]->snapshot();
+    }
+    const EditorTileStore &tileStore() const { return tileStore_; }
 
 protected:
     // Project
@@ -121,10 +139,14 @@ protected:
     void openUpdate();
     void updateBoundary();
     void resetRendering();
+    void resetLod();
 
-    // Cache
+    // Cache, tiles are shared by viewports and the working cache
+    EditorTileStore tileStore_;
     std::vector<std::shared_ptr<EditorCache>> viewports_;
+    size_t viewportActive_;
     EditorCache working_;
+    EditorLoader loader_;
 };
 
 #endif /* EDITOR_BASE_HPP */
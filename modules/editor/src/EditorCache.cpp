@@ -21,71 +21,201 @@
 
 #include <EditorBase.hpp>
 #include <EditorCache.hpp>
+#include <EditorLoader.hpp>
 #include <Error.hpp>
-#include <queue>
+#include <algorithm>
+#include <limits>
 
-EditorCache::EditorCache(EditorBase *editor) : editor_(editor)
+#define EDITOR_CACHE_PREFETCH_STEPS 2.0F
+#define EDITOR_CACHE_PREFETCH_MAX 50
+#define EDITOR_CACHE_RENDER_STEP_POINTS 32768
+
+EditorCache::Frame::Frame()
+    : renderStep(1),
+      renderStepCount(1),
+      pointCount(0)
+{
+}
+
+void EditorCache::Frame::resetFrame()
+{
+    renderStep = 1;
+}
+
+void EditorCache::Frame::nextFrame()
+{
+    renderStep++;
+}
+
+bool EditorCache::Frame::isStarted() const
+{
+    return renderStep == 1;
+}
+
+bool EditorCache::Frame::isFinished() const
+{
+    return renderStep > renderStepCount;
+}
+
+void EditorCache::Frame::setPointCount(size_t n)
+{
+    // Steps are bounded in size so that a frame fits its time budget
+    size_t step = EDITOR_CACHE_RENDER_STEP_POINTS;
+    pointCount = n;
+    renderStepCount = std::max((n + step - 1) / step, static_cast<size_t>(1));
+}
+
+void EditorCache::Frame::renderRange(size_t &begin, size_t &end) const
 {
-    cacheSizeMax_ = 200;
+    size_t step = renderStep;
+    size_t count = renderStepCount;
+    if (step > count)
+    {
+        begin = end = pointCount;
+        return;
+    }
+
+    begin = pointCount * (step - 1) / count;
+    end = pointCount * step / count;
+}
+
+EditorCache::Snapshot::Snapshot(
+    const std::vector<std::shared_ptr<EditorTile>> &view)
+    : tiles(view),
+      frames(view.size())
+{
+}
+
+EditorCache::EditorCache(EditorBase *editor,
+                         EditorTileStore *store,
+                         EditorLoader *loader)
+    : editor_(editor),
+      store_(store),
+      loader_(loader)
+{
+    cameraValid_ = false;
+    publish();
 }
 
 EditorCache::~EditorCache()
 {
+    clear();
 }
 
 void EditorCache::clear()
 {
-    cache_.clear();
-    lru_.clear();
+    unpin(view_);
+    view_.clear();
+    publish();
+    lod_.clear();
+    cameraValid_ = false;
 }
 
-void EditorCache::reload()
+void EditorCache::resetLod()
+{
+    // Selection is computed again from roots by the next camera update
+    lod_.clear();
+}
+
+void EditorCache::publish()
 {
-    for (auto &it : cache_)
+    // Painting keeps the previous snapshot until it finishes
+    std::atomic_store(&snapshot_, std::make_shared<Snapshot>(view_));
+
+    published_.resize(view_.size());
+    for (size_t i = 0; i < view_.size(); i++)
     {
-        it.second->view.resetFrame();
-        it.second->filtered = false;
-        it.second->filteredClass = false;
-        // it.second->loaded = false;
+        published_[i] = view_[i]->snapshot();
     }
 }
 
+std::shared_ptr<EditorCache::Snapshot> EditorCache::snapshot() const
+{
+    return std::atomic_load(&snapshot_);
+}
+
+void EditorCache::unpin(const std::vector<std::shared_ptr<EditorTile>> &tiles)
+{
+    for (const auto &it : tiles)
+    {
+        store_->unpin(*it);
+    }
+}
+
+void EditorCache::reload()
+{
+    resetRendering();
+}
+
 bool EditorCache::loadStep()
 {
-    for (size_t i = 0; i < lru_.size(); i++)
+    bool finished = true;
+
+    // Previous views stay on screen until tiles publish new ones, points
+    // drawn from the previous views are cleared by drawing all tiles again
+    bool republished = false;
+    for (size_t i = 0; i < view_.size(); i++)
     {
-        if (!lru_[i]->loaded)
+        std::shared_ptr<const EditorTile::View> view = view_[i]->snapshot();
+        if (view != published_[i])
         {
-            load(i);
-            editor_->applyFilters(lru_[i].get());
-            return false;
+            republished = republished || published_[i];
+            published_[i] = view;
         }
+    }
 
-        if (!lru_[i]->transformed)
+    if (republished)
+    {
+        resetRendering();
+    }
+
+    for (size_t i = 0; i < view_.size(); i++)
+    {
+        EditorTile *tile = view_[i].get();
+
+        if (tile->loading)
         {
-            lru_[i]->transform(editor_);
-            return false;
+            finished = false;
+            continue;
         }
 
-        if (!lru_[i]->filtered)
+        if (!tile->loaded || tile->filterPending)
         {
-            lru_[i]->filter(editor_);
-            editor_->applyFilters(lru_[i].get());
+            // Prepare all tiles of the view in background
+            if (loader_->numberOfThreads() > 0)
+            {
+                loader_->push(view_[i]);
+                finished = false;
+                continue;
+            }
+
+            // Prepare one tile per step
+            if (!tile->loaded)
+            {
+                load(i);
+                editor_->applyFilters(tile);
+            }
+            else if (tile->filter(editor_))
+            {
+                editor_->applyFilters(tile);
+            }
+            tile->publish();
+            store_->update(*tile);
             return false;
         }
 
-        if (!lru_[i]->view.isFinished())
+        if (!snapshot_->frames[i].isFinished())
         {
-            return false;
+            finished = false;
         }
     }
 
-    return true;
+    return finished;
 }
 
 void EditorCache::load(size_t idx)
 {
-    EditorTile *tile = lru_[idx].get();
+    EditorTile *tile = view_[idx].get();
     try
     {
         tile->read(editor_);
@@ -100,193 +230,166 @@ void EditorCache::load(size_t idx)
     }
 }
 
-void EditorCache::updateCamera(const Camera &camera)
+void EditorCache::updateCamera(const Camera &camera, size_t pointBudget)
 {
-    double eyeX = camera.eye[0];
-    double eyeY = camera.eye[1];
-    double eyeZ = camera.eye[2];
+    // The view changes only when the level of detail cut changes
+    if (lod_.update(editor_, camera, pointBudget))
+    {
+        std::vector<Key> keys;
+        lod_.selection(keys);
 
-    std::vector<std::shared_ptr<EditorTile>> viewPrev;
-    viewPrev = lru_;
+        // Tiles of the previous view stay pinned until the new view is pinned
+        std::vector<std::shared_ptr<EditorTile>> viewPrev;
+        viewPrev.swap(view_);
 
-    lru_.clear();
+        for (const auto &key : keys)
+        {
+            // Tiles may be shared with other viewports
+            view_.push_back(store_->pin(key));
+        }
 
-    std::multimap<double, Key> queue;
+        unpin(viewPrev);
+        publish();
+    }
 
-    for (size_t i = 0; i < editor_->dataSetSize(); i++)
+    resetRendering();
+
+    if (editor_->settings().cache().isPrefetchEnabled() &&
+        loader_->numberOfThreads() > 0)
     {
-        const EditorDataSet &ds = editor_->dataSet(i);
-        if (ds.visible)
-        {
-            queue.insert({0, {ds.id, 0}});
-        }
+        prefetch(camera);
+    }
+
+    camera_ = camera;
+    cameraValid_ = true;
+}
+
+void EditorCache::prefetch(const Camera &camera)
+{
+    if (!cameraValid_)
+    {
+        return;
     }
 
-    while (!queue.empty() && lru_.size() < cacheSizeMax_)
+    // Extrapolate linear motion of the eye from the last update
+    Vector3<float> motion = camera.eye - camera_.eye;
+    if (motion.length() < std::numeric_limits<float>::epsilon())
     {
-        const auto it = queue.begin();
-        Key nk = it->second;
-        queue.erase(it);
+        return;
+    }
 
-        const EditorDataSet &ds = editor_->dataSet(nk.dataSetId);
-        const FileIndex::Node *node;
-        const FileIndex &index = ds.index;
-        node = index.at(nk.tileId);
+    Camera predicted = camera;
+    predicted.eye = camera.eye + motion * EDITOR_CACHE_PREFETCH_STEPS;
 
-        if (editor_->clipFilter().enabled)
-        {
-            Aabb<double> box = index.boundary(node, index.boundary());
-            box.translate(ds.translation);
-            if (!editor_->clipFilter().box.intersects(box))
-            {
-                continue;
-            }
-        }
+    std::vector<Key> keys;
+    lod_.prefetch(keys, predicted);
 
-        auto search = cache_.find({nk.dataSetId, nk.tileId});
-        if (search != cache_.end())
-        {
-            lru_.push_back(search->second);
-        }
-        else
+    // Tiles which are not resident yet are loaded after the view
+    size_t n = 0;
+    for (const auto &key : keys)
+    {
+        if (n == EDITOR_CACHE_PREFETCH_MAX)
         {
-            if (viewPrev.size() > 0)
-            {
-                const EditorTile *lru = viewPrev[viewPrev.size() - 1].get();
-                Key nkrm = {lru->dataSetId, lru->tileId};
-                cache_.erase(nkrm);
-                viewPrev.resize(viewPrev.size() - 1);
-            }
-
-            std::shared_ptr<EditorTile> tile;
-            tile = std::make_shared<EditorTile>();
-            tile->dataSetId = nk.dataSetId;
-            tile->tileId = nk.tileId;
-            tile->loaded = false;
-            cache_[nk] = tile;
-            lru_.push_back(tile);
+            break;
         }
 
-        for (size_t i = 0; i < 8; i++)
+        std::shared_ptr<EditorTile> tile = store_->prefetch(key);
+        if (tile)
         {
-            if (node->next[i])
-            {
-                const FileIndex::Node *sub = index.at(node->next[i]);
-                Aabb<double> box = index.boundary(sub, editor_->boundaryView());
-
-                double radius = box.radius();
-                double distance = box.distance(eyeX, eyeY, eyeZ);
-                double w;
-
-                if (distance < radius)
-                {
-                    w = 0;
-                }
-                else
-                {
-                    distance = distance * 0.002;
-                    distance = distance * distance;
-                    w = distance / radius;
-                }
-
-                queue.insert({w, {nk.dataSetId, node->next[i]}});
-            }
+            loader_->push(tile, EditorLoader::PRIORITY_PREFETCH);
+            store_->unpin(*tile);
+            n++;
         }
     }
-
-    resetRendering();
 }
 
 void EditorCache::resetRendering()
 {
-    for (size_t i = 0; i < lru_.size(); i++)
+    for (auto &it : snapshot_->frames)
     {
-        lru_[i]->view.resetFrame();
+        it.resetFrame();
     }
 }
 
-bool EditorCache::Key::operator<(const Key &rhs) const
+size_t EditorCache::memorySize() const
 {
-    return (dataSetId < rhs.dataSetId) || (tileId < rhs.tileId);
+    size_t size = 0;
+
+    for (const auto &it : view_)
+    {
+        size += it->memorySize();
+    }
+
+    return size;
 }
 
-EditorTile *EditorCache::tile(size_t dataset, size_t index)
+size_t EditorCache::memorySize(EditorTile::Column column) const
 {
-    Key nk = {dataset, index};
+    size_t size = 0;
 
-    auto search = cache_.find(nk);
-    if (search != cache_.end())
+    for (const auto &it : view_)
     {
-        // Move found tile to top
-        for (size_t i = 0; i < lru_.size(); i++)
-        {
-            if (lru_[i] == search->second)
-            {
-                if (i > 0)
-                {
-                    std::shared_ptr<EditorTile> tmp = lru_[i];
-                    for (size_t j = i; j > 0; j--)
-                    {
-                        lru_[j] = lru_[j - 1];
-                    }
-                    lru_[0] = tmp;
-                }
-
-                break;
-            }
-        }
+        size += it->memorySize(column);
+    }
+
+    return size;
+}
 
-        return search->second.get();
+EditorTile *EditorCache::tile(size_t dataset, size_t index, uint32_t columns)
+{
+    // The last requested tile stays pinned until the next request
+    std::shared_ptr<EditorTile> tile = store_->pin({dataset, index});
+    unpin(view_);
+
+    // Take the tile over from the loader
+    if (tile->loading)
+    {
+        loader_->cancel();
+        loader_->finish();
     }
-    else
+    view_.resize(1);
+    view_[0] = tile;
+    publish();
+
+    // Tiles shared with viewports are prepared the same way as in view,
+    // filters changed since the tile was loaded are applied first
+    if (!tile->loaded || tile->filterPending)
     {
-        // LRU
-        if (lru_.size() > 0)
+        try
         {
-            size_t idx;
-
-            if (lru_.size() < cacheSizeMax_)
-            {
-                // Make room for new tile
-                lru_.resize(lru_.size() + 1);
-                idx = lru_.size() - 1;
-            }
-            else
+            if (!tile->loaded)
             {
-                // Drop oldest tile
-                idx = lru_.size() - 1;
-                Key nkrm = {lru_[idx]->dataSetId, lru_[idx]->tileId};
-                cache_.erase(nkrm);
+                tile->read(editor_);
+                editor_->applyFilters(tile.get());
             }
-
-            // New tile is on top
-            for (size_t j = idx; j > 0; j--)
+            else if (tile->filter(editor_))
             {
-                lru_[j] = lru_[j - 1];
+                editor_->applyFilters(tile.get());
             }
         }
-        else
+        catch (...)
         {
-            // First tile is on top
-            lru_.resize(1);
+            // error
         }
 
-        std::shared_ptr<EditorTile> tile = std::make_shared<EditorTile>();
-        tile->dataSetId = nk.dataSetId;
-        tile->tileId = nk.tileId;
-        tile->loaded = false;
-        cache_[nk] = tile;
-        lru_[0] = tile;
+        tile->publish();
+        store_->update(*tile);
+    }
 
+    // Additional columns requested by the caller count to the store budget
+    if (columns & ~tile->resident)
+    {
         try
         {
-            tile->read(editor_);
+            tile->load(editor_, columns);
         }
         catch (...)
         {
             // error
         }
 
-        return tile.get();
+        store_->update(*tile);
     }
+
+    return tile.get();
 }
@@ -23,46 +23,108 @@
 #define EDITOR_CACHE_HPP
 
 #include <Camera.hpp>
+#include <EditorLod.hpp>
 #include <EditorTile.hpp>
+#include <EditorTileStore.hpp>
+#include <atomic>
 
 class EditorBase;
+class EditorLoader;
 
-/** Editor Cache. */
+/** Editor Cache.
+    View of the shared tile store for one viewport. Tiles of this view
+    are pinned in the store, render progress is tracked per tile.
+*/
 class EditorCache
 {
 public:
-    EditorCache(EditorBase *editor);
+    /** Editor Cache Render Progress of one tile.
+        Visible points are drawn in steps of chunks in their progressive
+        order, each step refines the tile uniformly. Progress is advanced
+        by painting and read by the render thread.
+    */
+    class Frame
+    {
+    public:
+        Frame();
+
+        void resetFrame();
+        void nextFrame();
+        bool isStarted() const;
+        bool isFinished() const;
+
+        void setPointCount(size_t n);
+        void renderRange(size_t &begin, size_t &end) const;
+
+    protected:
+        std::atomic<size_t> renderStep;
+        std::atomic<size_t> renderStepCount;
+        size_t pointCount;
+    };
+
+    /** Editor Cache Snapshot.
+        Tiles in view with their render progress, published for painting
+        without the editor lock. The list of tiles does not change.
+    */
+    class Snapshot
+    {
+    public:
+        const std::vector<std::shared_ptr<EditorTile>> tiles;
+        std::vector<Frame> frames;
+
+        Snapshot(const std::vector<std::shared_ptr<EditorTile>> &view);
+    };
+
+    EditorCache(EditorBase *editor,
+                EditorTileStore *store,
+                EditorLoader *loader);
     ~EditorCache();
 
     void clear();
     void reload();
     bool loadStep();
-    void updateCamera(const Camera &camera);
+    void updateCamera(const Camera &camera, size_t pointBudget);
     void resetRendering();
+    void resetLod();
+
+    size_t tileSize() const { return view_.size(); }
+    EditorTile &tile(size_t index) { return *view_[index]; }
+    Frame &frame(size_t index) { return snapshot_->frames[index]; }
+    std::shared_ptr<Snapshot> snapshot() const;
+
+    EditorTile *tile(size_t dataset, size_t index, uint32_t columns = 0);
 
-    size_t tileSize() const { return lru_.size(); }
-    EditorTile &tile(size_t index) { return *lru_[index]; }
+    const Camera &camera() const { return camera_; }
+    bool hasCamera() const { return cameraValid_; }
 
-    EditorTile *tile(size_t dataset, size_t index);
+    size_t memorySize() const;
+    size_t memorySize(EditorTile::Column column) const;
 
 protected:
+    typedef EditorTileStore::Key Key;
+
     EditorBase *editor_;
+    EditorTileStore *store_;
+    EditorLoader *loader_;
 
-    // Cache
-    struct Key
-    {
-        size_t dataSetId;
-        size_t tileId;
+    // Tiles in view, pinned in the store
+    std::vector<std::shared_ptr<EditorTile>> view_;
+    std::shared_ptr<Snapshot> snapshot_;
 
-        bool operator<(const Key &rhs) const;
-    };
-    size_t cacheSizeMax_;
-    std::map<Key, std::shared_ptr<EditorTile>> cache_;
+    // Last known views of tiles in view, a new view is drawn again
+    std::vector<std::shared_ptr<const EditorTile::View>> published_;
+
+    // Level of detail cut, kept between camera updates
+    EditorLod lod_;
 
-    // Last Recently Used (LRU)
-    std::vector<std::shared_ptr<EditorTile>> lru_;
+    // Last camera, prefetch by camera motion
+    Camera camera_;
+    bool cameraValid_;
 
+    void prefetch(const Camera &camera);
+    void publish();
     void load(size_t idx);
+    void unpin(const std::vector<std::shared_ptr<EditorTile>> &tiles);
 };
 
 #endif /* EDITOR_CACHE_HPP */
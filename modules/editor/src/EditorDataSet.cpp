@@ -26,7 +26,7 @@
 #include <FileLas.hpp>
 #include <iostream>
 
-EditorDataSet::EditorDataSet() : id(0), visible(true)
+EditorDataSet::EditorDataSet() : id(0), visible(true), hasRgb(false)
 {
 }
 
@@ -163,6 +163,8 @@ void EditorDataSet::read()
         dateCreated = las.header.dateCreated();
     }
 
+    hasRgb = las.header.hasRgb();
+
     translationFile.set(las.header.x_offset,
                         las.header.y_offset,
                         las.header.z_offset);
@@ -177,6 +179,43 @@ void EditorDataSet::read()
 
     boundaryFile = index.boundaryPoints();
     updateBoundary();
+
+    readColumns();
+}
+
+void EditorDataSet::readColumns()
+{
+    // Optional columns file, the file itself is never modified here
+    columns.clear();
+    columnsMessage.clear();
+
+    const std::string pathColumns = FileColumns::extension(path);
+    if (!File::exists(pathColumns))
+    {
+        return;
+    }
+
+    // Stale columns file is ignored until it is rebuilt by 'las -k'
+    if (!FileColumns::isValid(path))
+    {
+        columnsMessage = "Columns file '" + pathColumns +
+                         "' is out of date, points are read from LAS. "
+                         "Rebuild it with 'las -k'.";
+        return;
+    }
+
+    try
+    {
+        columns.read(pathColumns);
+    }
+    catch (std::exception &e)
+    {
+        // Continue with LAS file
+        columns.clear();
+        columnsMessage = "Columns file '" + pathColumns +
+                         "' can not be read, points are read from LAS: " +
+                         e.what();
+    }
 }
 
 void EditorDataSet::updateBoundary()
@@ -23,6 +23,7 @@
 #define EDITOR_DATA_SET_HPP
 
 #include <Aabb.hpp>
+#include <FileColumns.hpp>
 #include <FileIndex.hpp>
 #include <Json.hpp>
 #include <Vector3.hpp>
@@ -48,6 +49,9 @@ public:
 
     // Data
     FileIndex index;
+    FileColumns columns;
+    std::string columnsMessage; /**< Why the columns file is not used */
+    bool hasRgb;
     Vector3<double> translationFile;
     Vector3<double> scalingFile;
     Aabb<double> boundaryFile;
@@ -69,6 +73,7 @@ public:
 protected:
     void setPath(const std::string &unresolved, const std::string &projectPath);
     void read();
+    void readColumns();
 };
 
 #endif /* EDITOR_DATA_SET_HPP */
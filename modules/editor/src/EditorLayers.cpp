@@ -90,6 +90,9 @@ void EditorLayers::clear()
 {
     layers_.resize(1);
     layers_[0].set(0, "main", true, {1.0F, 1.0F, 1.0F});
+
+    idHashTable_.clear();
+    idHashTable_.insert(layers_[0].id());
 }
 
 void EditorLayers::read(const Json &in)
@@ -111,9 +114,14 @@ void EditorLayers::read(const Json &in)
         clear();
         layers_.resize(n);
 
+        idHashTable_.clear();
         for (auto const &it : in["layers"].array())
         {
             layers_[i].read(it);
+            if (layers_[i].isEnabled())
+            {
+                idHashTable_.insert(layers_[i].id());
+            }
             i++;
         }
     }
@@ -0,0 +1,211 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/** @file EditorLoader.cpp */
+
+#include <EditorBase.hpp>
+#include <EditorLoader.hpp>
+#include <EditorTileStore.hpp>
+
+EditorLoader::EditorLoader(EditorBase *editor, EditorTileStore *store)
+    : editor_(editor),
+      store_(store),
+      active_(0),
+      exit_(false)
+{
+}
+
+EditorLoader::~EditorLoader()
+{
+    setNumberOfThreads(0);
+}
+
+void EditorLoader::setNumberOfThreads(size_t n)
+{
+    cancel();
+
+    // Stop all workers
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        exit_ = true;
+    }
+    condition_.notify_all();
+
+    for (auto &it : threads_)
+    {
+        it.join();
+    }
+    threads_.clear();
+    exit_ = false;
+
+    // Start new workers
+    for (size_t i = 0; i < n; i++)
+    {
+        threads_.push_back(std::thread(&EditorLoader::run, this));
+    }
+}
+
+void EditorLoader::setCallback(const Callback &callback)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    callback_ = callback;
+}
+
+void EditorLoader::push(const std::shared_ptr<EditorTile> &tile,
+                        Priority priority)
+{
+    store_->pin(*tile);
+    tile->loading = true;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (priority == PRIORITY_VIEW)
+        {
+            queue_.push_back(tile);
+        }
+        else
+        {
+            queuePrefetch_.push_back(tile);
+        }
+    }
+    condition_.notify_one();
+}
+
+void EditorLoader::finish()
+{
+    std::vector<std::shared_ptr<EditorTile>> tiles;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tiles.swap(finished_);
+    }
+
+    for (auto &it : tiles)
+    {
+        it->loading = false;
+        store_->update(*it);
+        store_->unpin(*it);
+    }
+}
+
+void EditorLoader::clearQueue()
+{
+    // Tiles which were not started are handed over unchanged
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &it : queue_)
+    {
+        finished_.push_back(it);
+    }
+    queue_.clear();
+
+    for (auto &it : queuePrefetch_)
+    {
+        finished_.push_back(it);
+    }
+    queuePrefetch_.clear();
+}
+
+void EditorLoader::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    conditionIdle_.wait(lock, [this] { return active_ == 0; });
+}
+
+void EditorLoader::cancel()
+{
+    clearQueue();
+    wait();
+}
+
+void EditorLoader::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (1)
+    {
+        condition_.wait(lock, [this] {
+            return exit_ || !queue_.empty() || !queuePrefetch_.empty();
+        });
+        if (exit_)
+        {
+            return;
+        }
+
+        // Tiles in view are loaded before prefetched tiles
+        std::shared_ptr<EditorTile> tile;
+        bool view = !queue_.empty();
+        if (view)
+        {
+            tile = queue_.front();
+            queue_.pop_front();
+        }
+        else
+        {
+            tile = queuePrefetch_.front();
+            queuePrefetch_.pop_front();
+        }
+        active_++;
+
+        lock.unlock();
+        compute(tile.get());
+        lock.lock();
+
+        finished_.push_back(tile);
+
+        // The worker is idle before the owner is notified, so cancel()
+        // does not return while a notification can still start new work
+        active_--;
+        if (active_ == 0)
+        {
+            conditionIdle_.notify_all();
+        }
+
+        // Notify the owner without waiting for the next step of the view
+        if (view && callback_)
+        {
+            Callback callback = callback_;
+            lock.unlock();
+            callback();
+            lock.lock();
+        }
+    }
+}
+
+void EditorLoader::compute(EditorTile *tile)
+{
+    try
+    {
+        if (!tile->loaded)
+        {
+            tile->read(editor_);
+            editor_->applyFilters(tile);
+        }
+        else if (tile->filter(editor_))
+        {
+            editor_->applyFilters(tile);
+        }
+    }
+    catch (...)
+    {
+        // error
+    }
+
+    tile->publish();
+}
@@ -0,0 +1,94 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/** @file EditorLoader.hpp */
+
+#ifndef EDITOR_LOADER_HPP
+#define EDITOR_LOADER_HPP
+
+#include <EditorTile.hpp>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class EditorBase;
+class EditorTileStore;
+
+/** Editor Loader.
+    Pool of worker threads which read, filter and color tiles in the
+    background. A tile is owned by the loader while its loading flag is
+    set, it stays pinned in the tile store until it is handed over.
+    push() and finish() are called with the editor locked. The queue has
+    its own mutex, clearQueue(), wait() and cancel() may be called without
+    the editor lock. The callback is invoked after the worker is idle, the
+    owner must not start new work from it while it is canceling threads.
+*/
+class EditorLoader
+{
+public:
+    /** Editor Loader Priority. */
+    enum Priority
+    {
+        PRIORITY_VIEW,
+        PRIORITY_PREFETCH
+    };
+
+    /** Called by a worker when a tile in view is ready to be handed over. */
+    typedef std::function<void()> Callback;
+
+    EditorLoader(EditorBase *editor, EditorTileStore *store);
+    ~EditorLoader();
+
+    void setNumberOfThreads(size_t n);
+    size_t numberOfThreads() const { return threads_.size(); }
+    void setCallback(const Callback &callback);
+
+    void push(const std::shared_ptr<EditorTile> &tile,
+              Priority priority = PRIORITY_VIEW);
+    void finish();
+
+    void clearQueue();
+    void wait();
+    void cancel();
+
+protected:
+    EditorBase *editor_;
+    EditorTileStore *store_;
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::condition_variable conditionIdle_;
+    std::deque<std::shared_ptr<EditorTile>> queue_;
+    std::deque<std::shared_ptr<EditorTile>> queuePrefetch_;
+    std::vector<std::shared_ptr<EditorTile>> finished_;
+    Callback callback_;
+    size_t active_;
+    bool exit_;
+
+    void run();
+    void compute(EditorTile *tile);
+};
+
+#endif /* EDITOR_LOADER_HPP */
@@ -0,0 +1,393 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file EditorLod.cpp */
+
+#include <EditorBase.hpp>
+#include <EditorLod.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#define EDITOR_LOD_SIZE_MIN 32.0
+#define EDITOR_LOD_THRESHOLD 0.1
+
+EditorLod::Projection::Projection(const Camera &camera)
+{
+    // Projection of size 1 at distance 1 to pixels
+    double fov = static_cast<double>(camera.fov) * 3.1415927 / 180.0;
+    double height = static_cast<double>(camera.height);
+    pixels = height / (2.0 * std::tan(fov * 0.5));
+
+    eye.set(camera.eye[0], camera.eye[1], camera.eye[2]);
+    distanceOrtho = static_cast<double>((camera.eye - camera.center).length());
+    perspective = camera.perspective;
+}
+
+double EditorLod::Projection::size(const Aabb<double> &box) const
+{
+    // Projected size of bounding sphere in pixels
+    double distance;
+    if (perspective)
+    {
+        distance = box.distance(eye[0], eye[1], eye[2]);
+    }
+    else
+    {
+        distance = distanceOrtho;
+    }
+
+    if (distance > 0.0)
+    {
+        return pixels * box.radius() / distance;
+    }
+
+    return std::numeric_limits<double>::max();
+}
+
+EditorLod::EditorLod() : editor_(nullptr), points_(0), pointBudget_(0)
+{
+}
+
+void EditorLod::clear()
+{
+    nodes_.clear();
+    frontier_ = FrontierQueue();
+    leaves_ = LeafQueue();
+    points_ = 0;
+}
+
+bool EditorLod::update(const EditorBase *editor,
+                       const Camera &camera,
+                       size_t pointBudget)
+{
+    editor_ = editor;
+    Projection projection(camera);
+    bool changed = false;
+
+    if (nodes_.empty())
+    {
+        insertRoots(projection);
+        changed = true;
+    }
+
+    if (pointBudget_ != pointBudget)
+    {
+        pointBudget_ = pointBudget;
+        changed = true;
+    }
+
+    // The cut is kept until some projected size changes past threshold
+    for (auto &it : nodes_)
+    {
+        Node &node = it.second;
+        if (!node.root)
+        {
+            node.sizeNew = projection.size(node.box);
+            if (std::abs(node.sizeNew - node.size) >
+                node.size * EDITOR_LOD_THRESHOLD)
+            {
+                changed = true;
+            }
+        }
+    }
+
+    if (!changed)
+    {
+        return false;
+    }
+
+    for (auto &it : nodes_)
+    {
+        Node &node = it.second;
+        if (!node.root)
+        {
+            node.size = node.sizeNew;
+        }
+        node.version++;
+    }
+
+    rebalance(projection);
+
+    return true;
+}
+
+void EditorLod::insertRoots(const Projection &projection)
+{
+    for (size_t i = 0; i < editor_->dataSetSize(); i++)
+    {
+        const EditorDataSet &ds = editor_->dataSet(i);
+        if (ds.visible)
+        {
+            insert(projection, {ds.id, 0}, {ds.id, 0}, true);
+        }
+    }
+}
+
+void EditorLod::insert(const Projection &projection,
+                       const Key &key,
+                       const Key &parent,
+                       bool root)
+{
+    const EditorDataSet &ds = editor_->dataSet(key.dataSetId);
+    const FileIndex &index = ds.index;
+    const FileIndex::Node *fileNode = index.at(key.tileId);
+
+    Node node;
+    node.parent = parent;
+    node.box = index.boundary(fileNode, editor_->boundaryView());
+    if (root)
+    {
+        node.size = std::numeric_limits<double>::max();
+    }
+    else
+    {
+        node.size = projection.size(node.box);
+    }
+    node.sizeNew = node.size;
+    node.points = static_cast<size_t>(fileNode->size);
+    node.selectedChildren = 0;
+    node.version = 0;
+    node.root = root;
+    node.clipped = false;
+    node.selected = false;
+
+    if (editor_->clipFilter().enabled)
+    {
+        Aabb<double> box = index.boundary(fileNode, index.boundary());
+        box.translate(ds.translation);
+        node.clipped = !editor_->clipFilter().box.intersects(box);
+    }
+
+    nodes_[key] = node;
+    push(key, node);
+}
+
+void EditorLod::rebalance(const Projection &projection)
+{
+    // Versions of all nodes changed, queues are built again
+    std::vector<Item> frontier;
+    std::vector<Item> leaves;
+    for (const auto &it : nodes_)
+    {
+        const Node &node = it.second;
+        Item item = {node.size, it.first, node.version};
+        if (node.selected && node.selectedChildren == 0)
+        {
+            leaves.push_back(item);
+        }
+        else if (!node.selected && !node.clipped &&
+                 node.size >= EDITOR_LOD_SIZE_MIN)
+        {
+            frontier.push_back(item);
+        }
+    }
+    frontier_ = FrontierQueue(std::less<Item>(), frontier);
+    leaves_ = LeafQueue(std::greater<Item>(), leaves);
+
+    while (true)
+    {
+        // Coarsen leaves which are too small or do not fit the budget
+        if (!leaves_.empty())
+        {
+            Item leaf = leaves_.top();
+            if (!isLeaf(leaf))
+            {
+                leaves_.pop();
+                continue;
+            }
+
+            if (points_ > pointBudget_ || leaf.size < EDITOR_LOD_SIZE_MIN)
+            {
+                leaves_.pop();
+                deselect(leaf.key);
+                continue;
+            }
+        }
+
+        // Refine nodes with largest projected size first
+        if (frontier_.empty())
+        {
+            break;
+        }
+
+        Item item = frontier_.top();
+        if (!isFrontier(item))
+        {
+            frontier_.pop();
+            continue;
+        }
+
+        const Node &node = nodes_.at(item.key);
+        if (points_ + node.points <= pointBudget_)
+        {
+            frontier_.pop();
+            select(projection, item.key);
+            continue;
+        }
+
+        // Replace a leaf with smaller projected size
+        if (!leaves_.empty())
+        {
+            Item leaf = leaves_.top();
+            if (leaf.size * (1.0 + EDITOR_LOD_THRESHOLD) < item.size &&
+                !(leaf.key == node.parent))
+            {
+                leaves_.pop();
+                deselect(leaf.key);
+                continue;
+            }
+        }
+
+        // Nodes which do not fit are not refined, smaller ones may fit
+        frontier_.pop();
+    }
+}
+
+void EditorLod::select(const Projection &projection, const Key &key)
+{
+    Node &node = nodes_.at(key);
+    node.selected = true;
+    node.version++;
+    points_ += node.points;
+    push(key, node);
+
+    if (!node.root)
+    {
+        nodes_.at(node.parent).selectedChildren++;
+    }
+
+    // Children enter the frontier
+    const FileIndex &index = editor_->dataSet(key.dataSetId).index;
+    const FileIndex::Node *fileNode = index.at(key.tileId);
+    for (size_t i = 0; i < 8; i++)
+    {
+        if (fileNode->next[i])
+        {
+            insert(projection, {key.dataSetId, fileNode->next[i]}, key, false);
+        }
+    }
+}
+
+void EditorLod::deselect(const Key &key)
+{
+    // Children of a leaf are in the frontier
+    const FileIndex &index = editor_->dataSet(key.dataSetId).index;
+    const FileIndex::Node *fileNode = index.at(key.tileId);
+    for (size_t i = 0; i < 8; i++)
+    {
+        if (fileNode->next[i])
+        {
+            nodes_.erase({key.dataSetId, fileNode->next[i]});
+        }
+    }
+
+    Node &node = nodes_.at(key);
+    node.selected = false;
+    node.version++;
+    points_ -= node.points;
+    push(key, node);
+
+    if (!node.root)
+    {
+        Node &parent = nodes_.at(node.parent);
+        parent.selectedChildren--;
+        if (parent.selectedChildren == 0)
+        {
+            push(node.parent, parent);
+        }
+    }
+}
+
+void EditorLod::push(const Key &key, const Node &node)
+{
+    Item item = {node.size, key, node.version};
+
+    if (node.selected)
+    {
+        if (node.selectedChildren == 0)
+        {
+            leaves_.push(item);
+        }
+    }
+    else if (!node.clipped && node.size >= EDITOR_LOD_SIZE_MIN)
+    {
+        frontier_.push(item);
+    }
+}
+
+bool EditorLod::isFrontier(const Item &item) const
+{
+    const auto it = nodes_.find(item.key);
+    return it != nodes_.end() && it->second.version == item.version &&
+           !it->second.selected;
+}
+
+bool EditorLod::isLeaf(const Item &item) const
+{
+    const auto it = nodes_.find(item.key);
+    return it != nodes_.end() && it->second.version == item.version &&
+           it->second.selected && it->second.selectedChildren == 0;
+}
+
+void EditorLod::selection(std::vector<Key> &keys) const
+{
+    // Nodes with largest projected size are rendered first
+    std::vector<Item> items;
+    for (const auto &it : nodes_)
+    {
+        if (it.second.selected)
+        {
+            items.push_back({it.second.size, it.first, 0});
+        }
+    }
+    std::stable_sort(items.begin(), items.end(), std::greater<Item>());
+
+    keys.resize(items.size());
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        keys[i] = items[i].key;
+    }
+}
+
+void EditorLod::prefetch(std::vector<Key> &keys, const Camera &camera) const
+{
+    // Frontier nodes are refined next, the largest ones at the new camera
+    Projection projection(camera);
+    std::vector<Item> items;
+    for (const auto &it : nodes_)
+    {
+        const Node &node = it.second;
+        if (!node.selected && !node.clipped)
+        {
+            double size = projection.size(node.box);
+            if (size >= EDITOR_LOD_SIZE_MIN)
+            {
+                items.push_back({size, it.first, 0});
+            }
+        }
+    }
+    std::stable_sort(items.begin(), items.end(), std::greater<Item>());
+
+    keys.resize(items.size());
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        keys[i] = items[i].key;
+    }
+}
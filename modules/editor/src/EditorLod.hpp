@@ -0,0 +1,122 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file EditorLod.hpp */
+
+#ifndef EDITOR_LOD_HPP
+#define EDITOR_LOD_HPP
+
+#include <Aabb.hpp>
+#include <Camera.hpp>
+#include <EditorTileStore.hpp>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+class EditorBase;
+
+/** Editor Level of Detail.
+    Cut through the octrees of visible data sets which is kept between
+    camera updates. The cut holds selected nodes and the children of
+    selected nodes which are not selected. A camera update recomputes
+    projected sizes of these nodes only. The cut is refined or coarsened
+    when some size changed past a threshold or the point budget changed.
+*/
+class EditorLod
+{
+public:
+    typedef EditorTileStore::Key Key;
+
+    EditorLod();
+
+    void clear();
+    bool update(const EditorBase *editor,
+                const Camera &camera,
+                size_t pointBudget);
+
+    void selection(std::vector<Key> &keys) const;
+    void prefetch(std::vector<Key> &keys, const Camera &camera) const;
+
+protected:
+    /** Editor Level of Detail Projection to pixels. */
+    struct Projection
+    {
+        Vector3<double> eye;
+        double pixels;
+        double distanceOrtho;
+        bool perspective;
+
+        Projection(const Camera &camera);
+        double size(const Aabb<double> &box) const;
+    };
+
+    /** Editor Level of Detail Node in the cut. */
+    struct Node
+    {
+        Key parent;
+        Aabb<double> box;
+        double size;
+        double sizeNew;
+        size_t points;
+        size_t selectedChildren;
+        uint32_t version;
+        bool root;
+        bool clipped;
+        bool selected;
+    };
+
+    /** Editor Level of Detail Queue Item, stale when version differs. */
+    struct Item
+    {
+        double size;
+        Key key;
+        uint32_t version;
+
+        bool operator<(const Item &rhs) const { return size < rhs.size; }
+        bool operator>(const Item &rhs) const { return size > rhs.size; }
+    };
+
+    const EditorBase *editor_;
+    std::unordered_map<Key, Node, EditorTileStore::KeyHash> nodes_;
+    size_t points_;
+    size_t pointBudget_;
+
+    typedef std::priority_queue<Item> FrontierQueue;
+    typedef std::priority_queue<Item, std::vector<Item>, std::greater<Item>>
+        LeafQueue;
+
+    // Frontier by largest size, selected leaves by smallest size
+    FrontierQueue frontier_;
+    LeafQueue leaves_;
+
+    void insertRoots(const Projection &projection);
+    void insert(const Projection &projection,
+                const Key &key,
+                const Key &parent,
+                bool root);
+    void rebalance(const Projection &projection);
+    void select(const Projection &projection, const Key &key);
+    void deselect(const Key &key);
+    void push(const Key &key, const Node &node);
+    bool isFrontier(const Item &item) const;
+    bool isLeaf(const Item &item) const;
+};
+
+#endif /* EDITOR_LOD_HPP */
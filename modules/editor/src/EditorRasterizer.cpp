@@ -0,0 +1,461 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file EditorRasterizer.cpp */
+
+#include <EditorBase.hpp>
+#include <EditorRasterizer.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+// Projection of the viewer
+#define EDITOR_RASTERIZER_Z_NEAR 0.01
+#define EDITOR_RASTERIZER_Z_FAR 100000.0
+#define EDITOR_RASTERIZER_ORTHO 28.9
+
+#define EDITOR_RASTERIZER_MEMORY (256 * 1024 * 1024)
+#define EDITOR_RASTERIZER_MARGIN 1.05
+#define EDITOR_RASTERIZER_INVALID std::numeric_limits<uint32_t>::max()
+
+EditorRasterizer::Statistics::Statistics() : bands(0), tiles(0), points(0)
+{
+}
+
+EditorRasterizer::EditorRasterizer()
+    : nThreads_(1),
+      memoryBudget_(EDITOR_RASTERIZER_MEMORY),
+      perspective_(true),
+      zNear_(0),
+      scaleX_(1),
+      scaleY_(1),
+      width_(0),
+      height_(0),
+      pointSize_(1),
+      bandY_(0),
+      bandRows_(0)
+{
+    setNumberOfThreads(std::thread::hardware_concurrency());
+}
+
+EditorRasterizer::~EditorRasterizer()
+{
+}
+
+void EditorRasterizer::setNumberOfThreads(size_t n)
+{
+    nThreads_ = (n > 0) ? n : 1;
+}
+
+void EditorRasterizer::setMemoryBudget(size_t bytes)
+{
+    memoryBudget_ = bytes;
+}
+
+void EditorRasterizer::render(EditorBase *editor,
+                              const Camera &camera,
+                              const Callback &callback)
+{
+    stats_ = Statistics();
+    setCamera(editor, camera);
+
+    // Rows of tiles in the image, tiles are loaded only for their bands
+    std::vector<Item> items;
+    for (size_t d = 0; d < editor->dataSetSize(); d++)
+    {
+        const EditorDataSet &dataSet = editor->dataSet(d);
+        if (!dataSet.visible)
+        {
+            continue;
+        }
+
+        const FileIndex &index = dataSet.index;
+        for (size_t t = 0; t < index.size(); t++)
+        {
+            Aabb<double> box = index.boundary(index.at(t), index.boundary());
+            box.translate(dataSet.translation);
+
+            Item item;
+            item.dataSetId = d;
+            item.tileId = t;
+            if (screenRows(box, item.y1, item.y2))
+            {
+                items.push_back(item);
+            }
+        }
+    }
+
+    // Color and depth of a band fit the memory budget
+    size_t rowSize = static_cast<size_t>(width_) * (3 + sizeof(float));
+    size_t bandSize = std::max(memoryBudget_ / rowSize, static_cast<size_t>(1));
+    bandSize = std::min(bandSize, static_cast<size_t>(height_));
+    rgb_.resize(bandSize * static_cast<size_t>(width_) * 3);
+    depth_.resize(bandSize * static_cast<size_t>(width_));
+
+    const Vector3<float> &background = editor->settings().view().background();
+
+    for (bandY_ = 0; bandY_ < height_; bandY_ += bandRows_)
+    {
+        bandRows_ = std::min(static_cast<int64_t>(bandSize), height_ - bandY_);
+        clear(background);
+
+        for (const auto &item : items)
+        {
+            if (item.y2 <= bandY_ || item.y1 >= bandY_ + bandRows_)
+            {
+                continue;
+            }
+
+            // The last tile stays pinned in the working cache
+            EditorTile *tile = editor->tile(item.dataSetId, item.tileId);
+            std::shared_ptr<const EditorTile::View> view = tile->snapshot();
+            if (view && !view->indices.empty())
+            {
+                const EditorDataSet &dataSet = editor->dataSet(tile->dataSetId);
+                draw(*tile, *view, dataSet.translation);
+            }
+        }
+
+        callback(rgb_.data(),
+                 static_cast<size_t>(bandY_),
+                 static_cast<size_t>(bandRows_));
+        stats_.bands++;
+    }
+
+    fragments_.clear();
+    fragments_.shrink_to_fit();
+}
+
+Camera EditorRasterizer::overview(const Aabb<double> &box,
+                                  size_t width,
+                                  size_t height)
+{
+    // Orthographic view from the top which fits the box
+    double aspect = static_cast<double>(width) / static_cast<double>(height);
+    double zNear = EDITOR_RASTERIZER_Z_NEAR;
+    double zFar = EDITOR_RASTERIZER_Z_FAR;
+    double top = EDITOR_RASTERIZER_ORTHO * 2.0 * zFar * zNear / (zFar - zNear);
+    double dx = (box.max(0) - box.min(0)) * 0.5 * EDITOR_RASTERIZER_MARGIN;
+    double dy = (box.max(1) - box.min(1)) * 0.5 * EDITOR_RASTERIZER_MARGIN;
+    double distance = std::max(std::max(dy, dx / aspect) / top, 1.0);
+
+    Vector3<double> center = box.getCenter();
+
+    Camera camera;
+    camera.eye.set(center[0], center[1], box.max(2) + distance);
+    camera.center.set(center[0], center[1], box.max(2));
+    camera.up.set(0.0F, 1.0F, 0.0F);
+    camera.width = width;
+    camera.height = height;
+    camera.perspective = false;
+
+    return camera;
+}
+
+void EditorRasterizer::setCamera(const EditorBase *editor,
+                                 const Camera &camera)
+{
+    width_ = static_cast<int64_t>(camera.width);
+    height_ = static_cast<int64_t>(camera.height);
+    double aspect = static_cast<double>(width_) / static_cast<double>(height_);
+
+    Vector3<double> eye;
+    Vector3<double> center;
+    Vector3<double> up;
+    eye = camera.eye;
+    center = camera.center;
+    up = camera.up;
+    view_.lookAt(eye, center, up);
+
+    double distance = (eye - center).length();
+    zNear_ = EDITOR_RASTERIZER_Z_NEAR * distance;
+
+    perspective_ = camera.perspective;
+    if (perspective_)
+    {
+        double fov = static_cast<double>(camera.fov) * 3.1415927 / 180.0;
+        double f = 1.0 / std::tan(fov * 0.5);
+        scaleX_ = f / aspect;
+        scaleY_ = f;
+    }
+    else
+    {
+        double zFar = EDITOR_RASTERIZER_Z_FAR * distance;
+        double top =
+            EDITOR_RASTERIZER_ORTHO * 2.0 * zFar * zNear_ / (zFar - zNear_);
+        scaleX_ = 1.0 / (aspect * top);
+        scaleY_ = 1.0 / top;
+    }
+
+    float pointSize = editor->settings().view().pointSize();
+    pointSize_ = std::max(static_cast<int64_t>(std::lround(pointSize)),
+                          static_cast<int64_t>(1));
+}
+
+bool EditorRasterizer::project(const Matrix4<double> &m,
+                               double x,
+                               double y,
+                               double z,
+                               double &sx,
+                               double &sy,
+                               double &depth) const
+{
+    double vx = m(0, 0) * x + m(0, 1) * y + m(0, 2) * z + m(0, 3);
+    double vy = m(1, 0) * x + m(1, 1) * y + m(1, 2) * z + m(1, 3);
+    double vz = m(2, 0) * x + m(2, 1) * y + m(2, 2) * z + m(2, 3);
+
+    // Image rows are from the top
+    depth = -vz;
+    if (perspective_)
+    {
+        if (depth <= zNear_)
+        {
+            return false;
+        }
+
+        vx = vx / depth;
+        vy = vy / depth;
+    }
+
+    sx = (1.0 + scaleX_ * vx) * 0.5 * static_cast<double>(width_);
+    sy = (1.0 - scaleY_ * vy) * 0.5 * static_cast<double>(height_);
+
+    return true;
+}
+
+bool EditorRasterizer::screenRows(const Aabb<double> &box,
+                                  int64_t &y1,
+                                  int64_t &y2) const
+{
+    double xMin = std::numeric_limits<double>::max();
+    double xMax = std::numeric_limits<double>::lowest();
+    double yMin = std::numeric_limits<double>::max();
+    double yMax = std::numeric_limits<double>::lowest();
+    size_t nBehind = 0;
+
+    for (size_t i = 0; i < 8; i++)
+    {
+        double x = (i & 1U) ? box.max(0) : box.min(0);
+        double y = (i & 2U) ? box.max(1) : box.min(1);
+        double z = (i & 4U) ? box.max(2) : box.min(2);
+        double sx;
+        double sy;
+        double depth;
+
+        if (project(view_, x, y, z, sx, sy, depth))
+        {
+            xMin = std::min(xMin, sx);
+            xMax = std::max(xMax, sx);
+            yMin = std::min(yMin, sy);
+            yMax = std::max(yMax, sy);
+        }
+        else
+        {
+            nBehind++;
+        }
+    }
+
+    if (nBehind == 8)
+    {
+        return false;
+    }
+
+    // The tile crosses the near plane, all rows may be covered
+    if (nBehind > 0)
+    {
+        y1 = 0;
+        y2 = height_;
+        return true;
+    }
+
+    double size = static_cast<double>(pointSize_);
+    if (xMax + size < 0.0 || xMin - size >= static_cast<double>(width_) ||
+        yMax + size < 0.0 || yMin - size >= static_cast<double>(height_))
+    {
+        return false;
+    }
+
+    y1 = std::max(static_cast<int64_t>(std::floor(yMin)) - pointSize_,
+                  static_cast<int64_t>(0));
+    y2 = std::min(static_cast<int64_t>(std::ceil(yMax)) + pointSize_ + 1,
+                  height_);
+
+    return y1 < y2;
+}
+
+void EditorRasterizer::clear(const Vector3<float> &background)
+{
+    uint8_t rgb[3];
+    for (size_t i = 0; i < 3; i++)
+    {
+        float v = std::min(std::max(background[i], 0.0F), 1.0F);
+        rgb[i] = static_cast<uint8_t>(std::lround(v * 255.0F));
+    }
+
+    size_t n = static_cast<size_t>(bandRows_ * width_);
+    for (size_t i = 0; i < n; i++)
+    {
+        rgb_[i * 3 + 0] = rgb[0];
+        rgb_[i * 3 + 1] = rgb[1];
+        rgb_[i * 3 + 2] = rgb[2];
+    }
+
+    std::fill(depth_.begin(),
+              depth_.begin() + static_cast<std::ptrdiff_t>(n),
+              std::numeric_limits<float>::max());
+}
+
+void EditorRasterizer::draw(const EditorTile &tile,
+                            const EditorTile::View &view,
+                            const Vector3<double> &translation)
+{
+    size_t n = view.indices.size();
+    fragments_.resize(n);
+
+    // Points are relative to the tile origin
+    Matrix4<double> m = view_;
+    Vector3<double> t = translation + tile.origin;
+    m.translate(t[0], t[1], t[2]);
+
+    // Threads project parts of the points
+    size_t nThreads = std::min(nThreads_, n);
+    parallel(nThreads, [&](size_t i) {
+        project(tile, view, m, n * i / nThreads, n * (i + 1) / nThreads);
+    });
+
+    // Threads splat all points into their own rows of the band
+    size_t nRows = static_cast<size_t>(bandRows_);
+    nThreads = std::min(nThreads_, nRows);
+    parallel(nThreads, [&](size_t i) {
+        int64_t y1 = bandY_ + static_cast<int64_t>(nRows * i / nThreads);
+        int64_t y2 = bandY_ + static_cast<int64_t>(nRows * (i + 1) / nThreads);
+        splat(view, y1, y2);
+    });
+
+    stats_.tiles++;
+    stats_.points += n;
+}
+
+void EditorRasterizer::project(const EditorTile &tile,
+                               const EditorTile::View &view,
+                               const Matrix4<double> &m,
+                               size_t begin,
+                               size_t end)
+{
+    double width = static_cast<double>(width_);
+    double size = static_cast<double>(pointSize_);
+    double bandY1 = static_cast<double>(bandY_);
+    double bandY2 = static_cast<double>(bandY_ + bandRows_);
+    int64_t half = (pointSize_ - 1) / 2;
+
+    for (size_t i = begin; i < end; i++)
+    {
+        Fragment &fragment = fragments_[i];
+        fragment.index = EDITOR_RASTERIZER_INVALID;
+
+        // Points are drawn from the same quantized positions as on screen
+        size_t idx = view.indices[i];
+        Vector3<double> p = tile.renderPosition(idx);
+        double sx;
+        double sy;
+        double depth;
+        if (!project(m, p[0], p[1], p[2], sx, sy, depth))
+        {
+            continue;
+        }
+
+        // Points which do not cover the band are skipped
+        if (sx + size < 0.0 || sx - size >= width || sy + size < bandY1 ||
+            sy - size >= bandY2)
+        {
+            continue;
+        }
+
+        fragment.x = static_cast<int64_t>(std::floor(sx)) - half;
+        fragment.y = static_cast<int64_t>(std::floor(sy)) - half;
+        fragment.depth = static_cast<float>(depth);
+        fragment.index = static_cast<uint32_t>(idx);
+    }
+}
+
+void EditorRasterizer::splat(const EditorTile::View &view,
+                             int64_t y1,
+                             int64_t y2)
+{
+    static const uint8_t white[4] = {255, 255, 255, 255};
+
+    for (const auto &fragment : fragments_)
+    {
+        if (fragment.index == EDITOR_RASTERIZER_INVALID ||
+            fragment.y >= y2 || fragment.y + pointSize_ <= y1)
+        {
+            continue;
+        }
+
+        const uint8_t *color = white;
+        if (!view.rgba.empty())
+        {
+            color = &view.rgba[static_cast<size_t>(fragment.index) * 4];
+        }
+
+        int64_t ya = std::max(fragment.y, y1);
+        int64_t yb = std::min(fragment.y + pointSize_, y2);
+        int64_t xa = std::max(fragment.x, static_cast<int64_t>(0));
+        int64_t xb = std::min(fragment.x + pointSize_, width_);
+
+        // Depth test, the first point wins on equal depth
+        for (int64_t y = ya; y < yb; y++)
+        {
+            size_t row = static_cast<size_t>((y - bandY_) * width_);
+            for (int64_t x = xa; x < xb; x++)
+            {
+                size_t p = row + static_cast<size_t>(x);
+                if (fragment.depth < depth_[p])
+                {
+                    depth_[p] = fragment.depth;
+                    rgb_[p * 3 + 0] = color[0];
+                    rgb_[p * 3 + 1] = color[1];
+                    rgb_[p * 3 + 2] = color[2];
+                }
+            }
+        }
+    }
+}
+
+void EditorRasterizer::parallel(size_t n,
+                                const std::function<void(size_t)> &function)
+{
+    // The calling thread takes the first part
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < n; i++)
+    {
+        threads.emplace_back(function, i);
+    }
+
+    if (n > 0)
+    {
+        function(0);
+    }
+
+    for (auto &it : threads)
+    {
+        it.join();
+    }
+}
@@ -0,0 +1,140 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file EditorRasterizer.hpp */
+
+#ifndef EDITOR_RASTERIZER_HPP
+#define EDITOR_RASTERIZER_HPP
+
+#include <Camera.hpp>
+#include <EditorTile.hpp>
+#include <functional>
+#include <vector>
+
+class EditorBase;
+
+/** Editor Rasterizer.
+    Software point renderer for images of any size, such as overviews
+    exported on servers without a display. The image is rendered in bands
+    of rows which fit a memory budget, tiles which cover a band are
+    streamed through the working cache of the editor.
+
+    Points of a tile are projected by worker threads, then each thread
+    splats them with a depth test into its own rows of the band. The
+    image does not depend on the number of threads. Projection, point
+    size and background match the viewer.
+*/
+class EditorRasterizer
+{
+public:
+    /** Called with finished rows [r0, g0, b0, r1, ...] from the top. */
+    typedef std::function<void(const uint8_t *rgb, size_t y, size_t rows)>
+        Callback;
+
+    /** Editor Rasterizer Statistics. */
+    struct Statistics
+    {
+        size_t bands;
+        size_t tiles;    /**< Tiles drawn, once for each band. */
+        uint64_t points; /**< Points projected. */
+
+        Statistics();
+    };
+
+    EditorRasterizer();
+    ~EditorRasterizer();
+
+    void setNumberOfThreads(size_t n);
+    void setMemoryBudget(size_t bytes);
+
+    void render(EditorBase *editor,
+                const Camera &camera,
+                const Callback &callback);
+
+    const Statistics &statistics() const { return stats_; }
+
+    static Camera overview(const Aabb<double> &box,
+                           size_t width,
+                           size_t height);
+
+protected:
+    /** Projected point, top left pixel of its splat. */
+    struct Fragment
+    {
+        int64_t x;
+        int64_t y;
+        float depth;
+        uint32_t index;
+    };
+
+    /** Tile with its rows in the image. */
+    struct Item
+    {
+        size_t dataSetId;
+        size_t tileId;
+        int64_t y1;
+        int64_t y2;
+    };
+
+    size_t nThreads_;
+    size_t memoryBudget_;
+    Statistics stats_;
+
+    // Projection
+    Matrix4<double> view_;
+    bool perspective_;
+    double zNear_;
+    double scaleX_;
+    double scaleY_;
+    int64_t width_;
+    int64_t height_;
+    int64_t pointSize_;
+
+    // Band
+    int64_t bandY_;
+    int64_t bandRows_;
+    std::vector<uint8_t> rgb_;
+    std::vector<float> depth_;
+    std::vector<Fragment> fragments_;
+
+    void setCamera(const EditorBase *editor, const Camera &camera);
+    bool project(const Matrix4<double> &m,
+                 double x,
+                 double y,
+                 double z,
+                 double &sx,
+                 double &sy,
+                 double &depth) const;
+    bool screenRows(const Aabb<double> &box, int64_t &y1, int64_t &y2) const;
+
+    void clear(const Vector3<float> &background);
+    void draw(const EditorTile &tile,
+              const EditorTile::View &view,
+              const Vector3<double> &translation);
+    void project(const EditorTile &tile,
+                 const EditorTile::View &view,
+                 const Matrix4<double> &m,
+                 size_t begin,
+                 size_t end);
+    void splat(const EditorTile::View &view, int64_t y1, int64_t y2);
+
+    void parallel(size_t n, const std::function<void(size_t)> &function);
+};
+
+#endif /* EDITOR_RASTERIZER_HPP */
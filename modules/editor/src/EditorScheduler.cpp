@@ -0,0 +1,205 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file EditorScheduler.cpp */
+
+#include <EditorScheduler.hpp>
+#include <Time.hpp>
+
+EditorScheduler::Latency::Latency() : count(0), last(0), max(0), total(0)
+{
+}
+
+void EditorScheduler::Latency::add(double seconds)
+{
+    count++;
+    last = seconds;
+    total += seconds;
+    if (seconds > max)
+    {
+        max = seconds;
+    }
+}
+
+double EditorScheduler::Latency::average() const
+{
+    if (count > 0)
+    {
+        return total / static_cast<double>(count);
+    }
+
+    return 0;
+}
+
+EditorScheduler::Statistics::Statistics()
+    : requests(0),
+      updates(0),
+      coalesced(0)
+{
+}
+
+EditorScheduler::Viewport::Viewport()
+    : inputTime(0),
+      updateTime(0),
+      valid(false),
+      pending(false),
+      waitingFirstPixel(false),
+      waitingFullDetail(false)
+{
+}
+
+EditorScheduler::EditorScheduler() : interactive_(0)
+{
+}
+
+void EditorScheduler::request(size_t viewportId, const Camera &camera)
+{
+    double now = getRealTime();
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (viewportId >= viewports_.size())
+    {
+        viewports_.resize(viewportId + 1);
+    }
+
+    // Latest camera wins, latency counts from the first input
+    Viewport &viewport = viewports_[viewportId];
+    if (viewport.pending)
+    {
+        statistics_.coalesced++;
+    }
+    else
+    {
+        viewport.inputTime = now;
+        viewport.pending = true;
+    }
+    viewport.camera = camera;
+    viewport.valid = true;
+
+    interactive_ = viewportId;
+    statistics_.requests++;
+}
+
+void EditorScheduler::repeat()
+{
+    double now = getRealTime();
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Views are selected again with the last cameras
+    for (auto &it : viewports_)
+    {
+        if (it.valid && !it.pending)
+        {
+            it.inputTime = now;
+            it.pending = true;
+        }
+    }
+}
+
+bool EditorScheduler::take(std::vector<Request> &requests)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    requests.clear();
+
+    // The interactive viewport is updated last and loaded first
+    size_t n = viewports_.size();
+    for (size_t i = 1; i <= n; i++)
+    {
+        size_t id = (interactive_ + i) % n;
+        Viewport &viewport = viewports_[id];
+        if (viewport.pending)
+        {
+            requests.push_back({id, viewport.camera});
+            viewport.updateTime = viewport.inputTime;
+            viewport.pending = false;
+            viewport.waitingFirstPixel = true;
+            viewport.waitingFullDetail = true;
+        }
+    }
+
+    statistics_.updates += requests.size();
+
+    return !requests.empty();
+}
+
+void EditorScheduler::firstPixel(size_t viewportId)
+{
+    double now = getRealTime();
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (viewportId < viewports_.size())
+    {
+        Viewport &viewport = viewports_[viewportId];
+        if (viewport.waitingFirstPixel)
+        {
+            statistics_.firstPixel.add(now - viewport.updateTime);
+            viewport.waitingFirstPixel = false;
+        }
+    }
+}
+
+void EditorScheduler::fullDetail()
+{
+    double now = getRealTime();
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (auto &it : viewports_)
+    {
+        if (it.waitingFullDetail)
+        {
+            statistics_.fullDetail.add(now - it.updateTime);
+            it.waitingFullDetail = false;
+        }
+    }
+}
+
+bool EditorScheduler::isIdle() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // All cameras are applied and their views are in full detail
+    for (const auto &it : viewports_)
+    {
+        if (it.pending || it.waitingFullDetail)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t EditorScheduler::interactiveViewport() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return interactive_;
+}
+
+EditorScheduler::Statistics EditorScheduler::statistics() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return statistics_;
+}
+
+void EditorScheduler::resetStatistics()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    statistics_ = Statistics();
+}
@@ -0,0 +1,108 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file EditorScheduler.hpp */
+
+#ifndef EDITOR_SCHEDULER_HPP
+#define EDITOR_SCHEDULER_HPP
+
+#include <Camera.hpp>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/** Editor Scheduler.
+    Camera updates passed from the user interface to the render thread.
+    Only the latest camera of each viewport is kept and the caller never
+    waits for the render thread. The viewport with the latest input is
+    interactive, its camera is applied last so that its view is loaded
+    first. Latency is measured from the first input which was coalesced
+    into the applied camera.
+*/
+class EditorScheduler
+{
+public:
+    /** Editor Scheduler Request. */
+    struct Request
+    {
+        size_t viewportId;
+        Camera camera;
+    };
+
+    /** Editor Scheduler Latency in seconds. */
+    struct Latency
+    {
+        uint64_t count;
+        double last;
+        double max;
+        double total;
+
+        Latency();
+        void add(double seconds);
+        double average() const;
+    };
+
+    /** Editor Scheduler Statistics. */
+    struct Statistics
+    {
+        uint64_t requests;
+        uint64_t updates;
+        uint64_t coalesced;
+        Latency firstPixel;
+        Latency fullDetail;
+
+        Statistics();
+    };
+
+    EditorScheduler();
+
+    void request(size_t viewportId, const Camera &camera);
+    void repeat();
+    bool take(std::vector<Request> &requests);
+
+    void firstPixel(size_t viewportId);
+    void fullDetail();
+
+    bool isIdle() const;
+    size_t interactiveViewport() const;
+    Statistics statistics() const;
+    void resetStatistics();
+
+protected:
+    /** Editor Scheduler Viewport. */
+    struct Viewport
+    {
+        Camera camera;
+        double inputTime;
+        double updateTime;
+        bool valid;
+        bool pending;
+        bool waitingFirstPixel;
+        bool waitingFullDetail;
+
+        Viewport();
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<Viewport> viewports_;
+    size_t interactive_;
+    Statistics statistics_;
+};
+
+#endif /* EDITOR_SCHEDULER_HPP */
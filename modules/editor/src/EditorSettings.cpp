@@ -21,11 +21,15 @@
 
 #include <EditorSettings.hpp>
 
+#define EDITOR_SETTINGS_CACHE_SIZE (1024 * 1024 * 1024)
+#define EDITOR_SETTINGS_POINT_BUDGET 20000000
+
 EditorSettings::View::View()
     : pointSize_(1.0F),
       fogEnabled_(false),
       pointColor_(1.0F, 1.0F, 1.0F),
-      background_(0.2F, 0.2F, 0.2F)
+      background_(0.2F, 0.2F, 0.2F),
+      pointBudget_(EDITOR_SETTINGS_POINT_BUDGET)
 {
     colorSourceString_ = {
         "Color",
@@ -55,6 +59,11 @@ void EditorSettings::View::setPointSize(float size)
     pointSize_ = size;
 }
 
+void EditorSettings::View::setPointBudget(size_t n)
+{
+    pointBudget_ = n;
+}
+
 bool EditorSettings::View::isFogEnabled() const
 {
     return fogEnabled_;
@@ -120,6 +129,15 @@ void EditorSettings::View::read(const Json &in)
     {
         background_.read(in["background"]);
     }
+
+    if (in.contains("pointBudget"))
+    {
+        pointBudget_ = static_cast<size_t>(in["pointBudget"].number());
+    }
+    else
+    {
+        pointBudget_ = EDITOR_SETTINGS_POINT_BUDGET;
+    }
 }
 
 Json &EditorSettings::View::write(Json &out) const
@@ -128,21 +146,78 @@ Json &EditorSettings::View::write(Json &out) const
     out["fog"]["enabled"] = fogEnabled_;
     pointColor_.write(out["pointColor"]);
     background_.write(out["background"]);
+    out["pointBudget"] = pointBudget_;
+
+    return out;
+}
+
+EditorSettings::Cache::Cache()
+    : size_(EDITOR_SETTINGS_CACHE_SIZE),
+      prefetchEnabled_(true)
+{
+}
+
+void EditorSettings::Cache::setSize(size_t bytes)
+{
+    size_ = bytes;
+}
+
+void EditorSettings::Cache::setPrefetchEnabled(bool b)
+{
+    prefetchEnabled_ = b;
+}
+
+void EditorSettings::Cache::read(const Json &in)
+{
+    if (in.contains("size"))
+    {
+        size_ = static_cast<size_t>(in["size"].number());
+    }
+    else
+    {
+        size_ = EDITOR_SETTINGS_CACHE_SIZE;
+    }
+
+    if (in.containsObject("prefetch") && in["prefetch"].contains("enabled"))
+    {
+        prefetchEnabled_ = in["prefetch"]["enabled"].isTrue();
+    }
+    else
+    {
+        prefetchEnabled_ = true;
+    }
+}
+
+Json &EditorSettings::Cache::write(Json &out) const
+{
+    out["size"] = size_;
+    out["prefetch"]["enabled"] = prefetchEnabled_;
 
     return out;
 }
 
+void EditorSettings::setCache(const Cache &cache)
+{
+    cache_ = cache;
+}
+
 void EditorSettings::read(const Json &in)
 {
     if (in.containsObject("view"))
     {
         view_.read(in["view"]);
     }
+
+    if (in.containsObject("cache"))
+    {
+        cache_.read(in["cache"]);
+    }
 }
 
 Json &EditorSettings::write(Json &out) const
 {
     view_.write(out["view"]);
+    cache_.write(out["cache"]);
 
     return out;
 }
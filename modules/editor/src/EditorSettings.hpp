@@ -59,6 +59,9 @@ public:
 
         const Vector3<float> &background() const { return background_; }
 
+        size_t pointBudget() const { return pointBudget_; }
+        void setPointBudget(size_t n);
+
         size_t colorSourceSize() const;
         const char *colorSourceString(size_t id) const;
         bool isColorSourceEnabled(size_t id) const;
@@ -72,18 +75,43 @@ public:
         bool fogEnabled_;
         Vector3<float> pointColor_;
         Vector3<float> background_;
+        size_t pointBudget_;
         std::vector<std::string> colorSourceString_;
         std::vector<bool> colorSourceEnabled_;
     };
 
+    /** Editor Settings Cache. */
+    class Cache
+    {
+    public:
+        Cache();
+
+        size_t size() const { return size_; }
+        void setSize(size_t bytes);
+
+        bool isPrefetchEnabled() const { return prefetchEnabled_; }
+        void setPrefetchEnabled(bool b);
+
+        void read(const Json &in);
+        Json &write(Json &out) const;
+
+    protected:
+        size_t size_;
+        bool prefetchEnabled_;
+    };
+
     const View &view() const { return view_; }
     void setView(const View &view);
 
+    const Cache &cache() const { return cache_; }
+    void setCache(const Cache &cache);
+
     void read(const Json &in);
     Json &write(Json &out) const;
 
 protected:
     View view_;
+    Cache cache_;
 };
 
 #endif /* EDITOR_SETTINGS_HPP */
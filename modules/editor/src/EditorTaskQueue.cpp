@@ -0,0 +1,217 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file EditorTaskQueue.cpp */
+
+#include <EditorTaskQueue.hpp>
+#include <algorithm>
+
+EditorTaskQueue::Token::Token()
+    : canceled_(std::make_shared<std::atomic<bool>>(false))
+{
+}
+
+void EditorTaskQueue::Token::cancel() const
+{
+    *canceled_ = true;
+}
+
+bool EditorTaskQueue::Token::isCanceled() const
+{
+    return *canceled_;
+}
+
+EditorTaskQueue::EditorTaskQueue() : exit_(false)
+{
+}
+
+EditorTaskQueue::~EditorTaskQueue()
+{
+    setNumberOfThreads(0);
+}
+
+void EditorTaskQueue::setNumberOfThreads(size_t n)
+{
+    cancel();
+
+    // Stop all workers
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        exit_ = true;
+    }
+    condition_.notify_all();
+
+    for (auto &it : threads_)
+    {
+        it.join();
+    }
+    threads_.clear();
+    exit_ = false;
+
+    // Start new workers
+    for (size_t i = 0; i < n; i++)
+    {
+        threads_.push_back(std::thread(&EditorTaskQueue::run, this));
+    }
+}
+
+EditorTaskQueue::Token EditorTaskQueue::push(const Step &step,
+                                             Priority priority,
+                                             const Callback &callback)
+{
+    Task task;
+    task.step = step;
+    task.callback = callback;
+    task.priority = priority;
+
+    Token token = task.token;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_[priority].push_back(std::move(task));
+    }
+    condition_.notify_one();
+
+    return token;
+}
+
+void EditorTaskQueue::cancel()
+{
+    // Must not be called by a task, it waits until all steps are done
+    std::vector<Task> canceled;
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        // Queued tasks are removed, running tasks stop after their step
+        for (auto &queue : queue_)
+        {
+            for (auto &it : queue)
+            {
+                canceled.push_back(std::move(it));
+            }
+            queue.clear();
+        }
+
+        for (const auto &it : running_)
+        {
+            it.cancel();
+        }
+    }
+
+    for (auto &it : canceled)
+    {
+        it.token.cancel();
+        if (it.callback)
+        {
+            it.callback(true);
+        }
+    }
+
+    // Callbacks of running tasks are called before the workers are idle
+    std::unique_lock<std::mutex> lock(mutex_);
+    conditionIdle_.wait(lock, [this] { return running_.empty(); });
+}
+
+void EditorTaskQueue::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    conditionIdle_.wait(lock, [this] { return running_.empty() && empty(); });
+}
+
+bool EditorTaskQueue::isIdle() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_.empty() && empty();
+}
+
+void EditorTaskQueue::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (1)
+    {
+        condition_.wait(lock, [this] { return exit_ || !empty(); });
+        if (exit_)
+        {
+            return;
+        }
+
+        Task task;
+        take(task);
+        running_.push_back(task.token);
+
+        lock.unlock();
+
+        bool finished = true;
+        if (!task.token.isCanceled())
+        {
+            finished = task.step(task.token);
+        }
+
+        bool canceled = task.token.isCanceled();
+        if ((finished || canceled) && task.callback)
+        {
+            task.callback(canceled);
+        }
+
+        lock.lock();
+
+        running_.erase(
+            std::find(running_.begin(), running_.end(), task.token));
+
+        // Unfinished task goes behind tasks of the same priority
+        if (!finished && !canceled)
+        {
+            queue_[task.priority].push_back(std::move(task));
+        }
+
+        if (running_.empty())
+        {
+            conditionIdle_.notify_all();
+        }
+    }
+}
+
+bool EditorTaskQueue::empty() const
+{
+    for (const auto &it : queue_)
+    {
+        if (!it.empty())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void EditorTaskQueue::take(Task &task)
+{
+    // The first task with the highest priority
+    for (auto &it : queue_)
+    {
+        if (!it.empty())
+        {
+            task = std::move(it.front());
+            it.pop_front();
+            return;
+        }
+    }
+}
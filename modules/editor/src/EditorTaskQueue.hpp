@@ -0,0 +1,117 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file EditorTaskQueue.hpp */
+
+#ifndef EDITOR_TASK_QUEUE_HPP
+#define EDITOR_TASK_QUEUE_HPP
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** Editor Task Queue.
+    Worker threads which run tasks by priority. A task is computed in
+    steps, an unfinished task is queued again after each step, so that
+    tasks with higher priority and cancellation are handled in between.
+    Workers wait on a condition variable while there is nothing to do.
+*/
+class EditorTaskQueue
+{
+public:
+    /** Editor Task Queue Priority. */
+    enum Priority
+    {
+        PRIORITY_HIGH,
+        PRIORITY_NORMAL,
+        PRIORITY_LOW,
+        PRIORITY_COUNT
+    };
+
+    /** Editor Task Queue Token.
+        Shared by a task and its owner, a canceled task does not run any
+        further step.
+    */
+    class Token
+    {
+    public:
+        Token();
+
+        void cancel() const;
+        bool isCanceled() const;
+
+        bool operator==(const Token &other) const
+        {
+            return canceled_ == other.canceled_;
+        }
+
+    protected:
+        std::shared_ptr<std::atomic<bool>> canceled_;
+    };
+
+    /** One step of a task, returns true when the task is finished. */
+    typedef std::function<bool(const Token &)> Step;
+
+    /** Called once by the worker when the task is finished or canceled. */
+    typedef std::function<void(bool canceled)> Callback;
+
+    EditorTaskQueue();
+    ~EditorTaskQueue();
+
+    void setNumberOfThreads(size_t n);
+    size_t numberOfThreads() const { return threads_.size(); }
+
+    Token push(const Step &step,
+               Priority priority = PRIORITY_NORMAL,
+               const Callback &callback = Callback());
+
+    void cancel();
+    void wait();
+    bool isIdle() const;
+
+protected:
+    /** Editor Task Queue Task. */
+    struct Task
+    {
+        Step step;
+        Callback callback;
+        Token token;
+        Priority priority;
+    };
+
+    std::vector<std::thread> threads_;
+    mutable std::mutex mutex_;
+    std::condition_variable condition_;
+    std::condition_variable conditionIdle_;
+    std::array<std::deque<Task>, PRIORITY_COUNT> queue_;
+    std::vector<Token> running_;
+    bool exit_;
+
+    void run();
+    bool empty() const;
+    void take(Task &task);
+};
+
+#endif /* EDITOR_TASK_QUEUE_HPP */
@@ -22,18 +22,35 @@
 #include <ColorPalette.hpp>
 #include <EditorBase.hpp>
 #include <EditorTile.hpp>
+#include <EditorTileFilter.hpp>
+#include <Error.hpp>
 #include <File.hpp>
+#include <FileColumns.hpp>
 #include <FileIndexBuilder.hpp>
 #include <FileLas.hpp>
+#include <FileLasCompression.hpp>
+#include <algorithm>
+#include <cmath>
+
+/** Convert 16-bit color channel to 8 bits with rounding. */
+static uint8_t toU8(uint16_t value)
+{
+    uint32_t v = static_cast<uint32_t>(value);
+    return static_cast<uint8_t>((v * 255U + 32767U) / 65535U);
+}
 
 EditorTile::EditorTile()
     : dataSetId(0),
       tileId(0),
+      resident(0),
       loaded(false),
-      transformed(false),
-      filtered(false),
-      filteredClass(false),
-      modified(false)
+      filterPending(filterMaskAll()),
+      filterCached(0),
+      skipped(false),
+      modified(false),
+      loading(false),
+      view(std::make_shared<View>()),
+      shared_(false)
 {
 }
 
@@ -41,7 +58,7 @@ EditorTile::~EditorTile()
 {
 }
 
-EditorTile::View::View() : renderStep(1), renderStepCount(1)
+EditorTile::View::View()
 {
 }
 
@@ -49,407 +66,815 @@ EditorTile::View::~View()
 {
 }
 
-void EditorTile::View::resetFrame()
+void EditorTile::View::setColor(size_t idx, float r, float g, float b)
+{
+    const float s = 255.0F;
+    rgba[idx * 4 + 0] = static_cast<uint8_t>(std::min(r, 1.0F) * s + 0.5F);
+    rgba[idx * 4 + 1] = static_cast<uint8_t>(std::min(g, 1.0F) * s + 0.5F);
+    rgba[idx * 4 + 2] = static_cast<uint8_t>(std::min(b, 1.0F) * s + 0.5F);
+    rgba[idx * 4 + 3] = 255;
+}
+
+void EditorTile::View::multiplyColor(size_t idx, const Vector3<float> &color)
 {
-    renderStep = 1;
+    const float s = 1.0F / 255.0F;
+    setColor(idx,
+             static_cast<float>(rgba[idx * 4 + 0]) * s * color[0],
+             static_cast<float>(rgba[idx * 4 + 1]) * s * color[1],
+             static_cast<float>(rgba[idx * 4 + 2]) * s * color[2]);
 }
 
-void EditorTile::View::nextFrame()
+void EditorTile::publish()
 {
-    renderStep++;
+    std::atomic_store(&snapshot_, std::shared_ptr<const View>(view));
+    shared_ = true;
 }
 
-bool EditorTile::View::isStarted() const
+void EditorTile::copyOnWrite()
 {
-    return renderStep == 1;
+    // Readers keep the published view until publish() replaces it
+    if (shared_)
+    {
+        view = std::make_shared<View>(*view);
+        shared_ = false;
+    }
 }
 
-bool EditorTile::View::isFinished() const
+std::shared_ptr<const EditorTile::View> EditorTile::snapshot() const
 {
-    return renderStep > renderStepCount;
+    return std::atomic_load(&snapshot_);
 }
 
 void EditorTile::read(const EditorBase *editor)
 {
+    // Point data columns are read by filter unless the tile is skipped
+    resident = 0;
+    skipped = false;
+
+    // Loaded
+    loaded = true;
+    filterPending = filterMaskAll();
+
+    // Apply
+    filter(editor);
+}
+
+void EditorTile::load(const EditorBase *editor, uint32_t mask)
+{
+    mask = mask & ~resident;
+    if (!mask)
+    {
+        return;
+    }
+
     const EditorDataSet &dataSet = editor->dataSet(dataSetId);
     const FileIndex::Node *node = dataSet.index.at(tileId);
+    size_t n = static_cast<size_t>(node->size);
 
-    // Read tile buffer from LAS file
-    FileLas las;
-    las.open(dataSet.path);
-    las.readHeader();
+    // Create columns which are not resident yet
+    std::vector<uint16_t> intensity16;
+    std::vector<uint16_t> rgb16;
+    std::vector<uint16_t> rgbOutput16;
+    std::vector<uint8_t> attrib8;
 
-    size_t pointSize = las.header.point_data_record_length;
-    uint64_t start = node->from * pointSize;
-    las.seek(start + las.header.offset_to_point_data);
+    FileLas::Columns fileColumns;
 
-    std::vector<uint8_t> buffer;
-    size_t n = static_cast<size_t>(node->size);
-    size_t bufferSize = pointSize * n;
-    uint8_t fmt = las.header.point_data_record_format;
-    buffer.resize(bufferSize);
-    las.file().read(buffer.data(), bufferSize);
+    // Point coordinates are read for the render format and for filters,
+    // they are kept only when requested
+    const uint32_t maskPositions =
+        columnMask(COLUMN_XYZ) | columnMask(COLUMN_RENDER);
+    std::vector<float> positions;
+    std::vector<double> xyzFile;
+
+    if (mask & maskPositions)
+    {
+        positions.resize(n * 3);
+        if (dataSet.columns.empty())
+        {
+            xyzFile.resize(n * 3);
+            fileColumns.xyz = xyzFile.data();
+        }
+        else
+        {
+            readPositions(dataSet, positions, n);
+        }
+    }
 
-    // Create point data
-    indices.resize(n);
+    if (mask & columnMask(COLUMN_INTENSITY))
+    {
+        intensity.resize(n);
+        intensity16.resize(n);
+        fileColumns.intensity = intensity16.data();
+    }
 
-    xyz.resize(n * 3);
-    xyzBase.resize(n * 3);
+    if (mask & columnMask(COLUMN_RGB))
+    {
+        rgb.resize(n * 3);
+        if (dataSet.hasRgb)
+        {
+            rgb16.resize(n * 3);
+            fileColumns.rgb = rgb16.data();
+        }
+    }
 
-    intensity.resize(n);
-    rgb.resize(n * 3);
-    rgbOutput.resize(n * 3);
-    attrib.resize(n);
-    gpsTime.resize(n);
-    layer.resize(n);
+    if (mask & columnMask(COLUMN_RGB_OUTPUT))
+    {
+        rgbOutput.resize(n * 3);
+        rgbOutput16.resize(n * 3);
+        fileColumns.userRgb = rgbOutput16.data();
+    }
 
-    view.xyz.resize(n * 3);
-    view.rgb.resize(n * 3);
+    if (mask & columnMask(COLUMN_ATTRIB))
+    {
+        attrib.resize(n);
+        attrib8.resize(n * 4);
+        fileColumns.returnNumber = attrib8.data();
+        fileColumns.numberOfReturns = attrib8.data() + n;
+        fileColumns.classification = attrib8.data() + n * 2;
+        fileColumns.userData = attrib8.data() + n * 3;
+    }
+
+    if (mask & columnMask(COLUMN_GPS_TIME))
+    {
+        gpsTime.resize(n);
+        fileColumns.gpsTime = gpsTime.data();
+    }
 
-    // Covert buffer to point data
-    uint8_t *ptr = buffer.data();
-    FileLas::Point point;
+    if (mask & columnMask(COLUMN_LAYER))
+    {
+        layer.resize(n);
+        fileColumns.userLayer = layer.data();
+    }
+
+    // Read point data columns, colors of data sets without colors are not
+    // stored in the file
+    uint32_t maskFile = mask;
+    if (!dataSet.hasRgb)
+    {
+        maskFile = maskFile & ~columnMask(COLUMN_RGB);
+    }
+
+    if (dataSet.columns.empty())
+    {
+        if (maskFile)
+        {
+            readLas(dataSet, fileColumns, n);
+        }
+    }
+    else
+    {
+        if (maskFile & ~maskPositions)
+        {
+            readColumns(dataSet, fileColumns, n);
+        }
+    }
+
+    // Normalize to point data
     const float scaleU16 =
         1.0F / 65535.0F; /**< @todo Normalize during conversion. */
     // const float scaleU16 = 1.0F / 255.0F;
-    bool rgbFlag = las.header.hasRgb();
 
-    for (size_t i = 0; i < n; i++)
+    if (!xyzFile.empty())
     {
-        indices[i] = static_cast<unsigned int>(i);
-
-        las.readPoint(point, ptr + (pointSize * i), fmt);
-
-        // xyz
-        xyzBase[3 * i + 0] = static_cast<double>(point.x);
-        xyzBase[3 * i + 1] = static_cast<double>(point.y);
-        xyzBase[3 * i + 2] = static_cast<double>(point.z);
+        // Positions relative to the minimum of the tile, the origin is set
+        // once because the tile may be drawn while columns are added
+        if (!(resident & maskPositions))
+        {
+            boundary.set(xyzFile);
+            origin.set(boundary.min(0), boundary.min(1), boundary.min(2));
+        }
+        for (size_t i = 0; i < n * 3; i++)
+        {
+            positions[i] = static_cast<float>(xyzFile[i] - origin[i % 3]);
+        }
+    }
 
-        // intensity and color
-        intensity[i] = static_cast<float>(point.intensity) * scaleU16;
+    if (mask & columnMask(COLUMN_INTENSITY))
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            intensity[i] = static_cast<float>(intensity16[i]) * scaleU16;
+        }
+    }
 
-        if (rgbFlag)
+    if (mask & columnMask(COLUMN_RGB))
+    {
+        if (dataSet.hasRgb)
         {
-            rgb[3 * i + 0] = point.red * scaleU16;
-            rgb[3 * i + 1] = point.green * scaleU16;
-            rgb[3 * i + 2] = point.blue * scaleU16;
+            for (size_t i = 0; i < n * 3; i++)
+            {
+                rgb[i] = toU8(rgb16[i]);
+            }
         }
         else
         {
-            rgb[3 * i + 0] = 1.0F;
-            rgb[3 * i + 1] = 1.0F;
-            rgb[3 * i + 2] = 1.0F;
+            std::fill(rgb.begin(), rgb.end(), static_cast<uint8_t>(255));
         }
+    }
 
-        rgbOutput[3 * i + 0] = point.user_red * scaleU16;
-        rgbOutput[3 * i + 1] = point.user_green * scaleU16;
-        rgbOutput[3 * i + 2] = point.user_blue * scaleU16;
-
-        // Attributes
-        Attributes &attribute = attrib[i];
-        attribute.returnNumber = point.return_number;
-        attribute.numberOfReturns = point.number_of_returns;
-        attribute.classification = point.classification;
+    if (mask & columnMask(COLUMN_RGB_OUTPUT))
+    {
+        for (size_t i = 0; i < n * 3; i++)
+        {
+            rgbOutput[i] = toU8(rgbOutput16[i]);
+        }
+    }
 
-        // GPS
-        gpsTime[i] = point.gps_time;
+    if (mask & columnMask(COLUMN_ATTRIB))
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            Attributes &attribute = attrib[i];
+            attribute.returnNumber = fileColumns.returnNumber[i];
+            attribute.numberOfReturns = fileColumns.numberOfReturns[i];
+            attribute.classification = fileColumns.classification[i];
+            attribute.userData = fileColumns.userData[i];
+        }
+    }
 
-        // Layer
-        layer[i] = point.user_layer;
+    if (mask & columnMask(COLUMN_RENDER))
+    {
+        quantize(positions);
     }
 
-    // Loaded
-    loaded = true;
+    if (mask & columnMask(COLUMN_XYZ))
+    {
+        xyz.swap(positions);
+    }
 
-    // Apply
-    transform(editor);
-    filter(editor);
+    resident = resident | mask;
 }
 
-void EditorTile::transform(const EditorBase *editor)
+void EditorTile::quantize(const std::vector<float> &positions)
 {
-    const EditorDataSet &dataSet = editor->dataSet(dataSetId);
-    size_t n = xyzBase.size() / 3;
-    double x;
-    double y;
-    double z;
-    double tx = dataSet.translation[0];
-    double ty = dataSet.translation[1];
-    double tz = dataSet.translation[2];
+    // 16-bit steps over the tile boundary, centered around zero
+    const double steps = 65535.0;
+    const double half = 32768.0;
 
-    for (size_t i = 0; i < n; i++)
+    for (size_t k = 0; k < 3; k++)
     {
-        x = xyzBase[3 * i + 0] + tx;
-        y = xyzBase[3 * i + 1] + ty;
-        z = xyzBase[3 * i + 2] + tz;
+        double extent = boundary.max(k) - origin[k];
+        renderScale[k] = (extent > 0) ? extent / steps : 1.0;
+        renderOrigin[k] = half * renderScale[k];
+    }
 
-        xyz[3 * i + 0] = x;
-        xyz[3 * i + 1] = y;
-        xyz[3 * i + 2] = z;
+    size_t n = positions.size() / 3;
+    renderXyz.resize(n * 3);
 
-        view.xyz[3 * i + 0] = static_cast<float>(x);
-        view.xyz[3 * i + 1] = static_cast<float>(y);
-        view.xyz[3 * i + 2] = static_cast<float>(z);
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t k = 0; k < 3; k++)
+        {
+            double q = static_cast<double>(positions[i * 3 + k]) /
+                       renderScale[k];
+            q = std::max(0.0, std::min(steps, std::round(q)));
+            renderXyz[i * 3 + k] = static_cast<int16_t>(q - half);
+        }
     }
 
-    boundary.set(xyz);
-    view.boundary.set(view.xyz);
+    sortRenderOrder();
+}
 
-    transformed = true;
+Vector3<double> EditorTile::renderPosition(size_t idx) const
+{
+    return Vector3<double>(
+        renderOrigin[0] +
+            renderScale[0] * static_cast<double>(renderXyz[idx * 3 + 0]),
+        renderOrigin[1] +
+            renderScale[1] * static_cast<double>(renderXyz[idx * 3 + 1]),
+        renderOrigin[2] +
+            renderScale[2] * static_cast<double>(renderXyz[idx * 3 + 2]));
 }
 
-void EditorTile::filter(const EditorBase *editor)
+/** Spread the lower 10 bits of a value to every third bit. */
+static uint64_t spreadBits(uint64_t v)
 {
-    size_t n = attrib.size();
-    indices.resize(n);
+    v &= 0x3ffULL;
+    v = (v | (v << 16)) & 0x30000ffULL;
+    v = (v | (v << 8)) & 0x300f00fULL;
+    v = (v | (v << 4)) & 0x30c30c3ULL;
+    v = (v | (v << 2)) & 0x9249249ULL;
+    return v;
+}
+
+void EditorTile::sortRenderOrder()
+{
+    size_t n = renderXyz.size() / 3;
+
+    // Points along a Z-order curve, the point index is in the lower bits
+    std::vector<uint64_t> keys(n);
     for (size_t i = 0; i < n; i++)
     {
-        indices[i] = static_cast<unsigned int>(i);
+        uint64_t code = 0;
+        for (size_t k = 0; k < 3; k++)
+        {
+            int32_t q = renderXyz[i * 3 + k];
+            uint64_t cell = static_cast<uint64_t>(q + 32768) >> 6;
+            code |= spreadBits(cell) << k;
+        }
+        keys[i] = (code << 32) | static_cast<uint64_t>(i);
     }
+    std::sort(keys.begin(), keys.end());
 
-    selectClip(editor);
-    selectClass(editor);
-    selectLayers(editor);
-    setPointColor(editor);
+    // Curve positions in bit reversed order, each prefix samples the
+    // curve at regular steps
+    size_t bits = 0;
+    while ((static_cast<size_t>(1) << bits) < n)
+    {
+        bits++;
+    }
+
+    renderOrder.resize(n);
+    size_t m = static_cast<size_t>(1) << bits;
+    size_t j = 0;
+    for (size_t p = 0; p < m; p++)
+    {
+        size_t r = 0;
+        for (size_t b = 0; b < bits; b++)
+        {
+            r |= ((p >> b) & 1U) << (bits - 1 - b);
+        }
 
-    filtered = true;
-    filteredClass = true;
+        if (r < n)
+        {
+            renderOrder[j++] = static_cast<unsigned int>(keys[r]);
+        }
+    }
 }
 
-bool EditorTile::renderMore() const
+uint32_t EditorTile::columnsRequired(const EditorBase *editor)
 {
-    return loaded && transformed && filtered && filteredClass &&
-           !view.isFinished();
+    const EditorSettings::View &opt = editor->settings().view();
+    uint32_t mask = columnMask(COLUMN_RENDER);
+
+    if (editor->clipFilter().enabled)
+    {
+        mask |= columnMask(COLUMN_XYZ);
+    }
+
+    if (opt.isColorSourceEnabled(opt.COLOR_SOURCE_COLOR))
+    {
+        mask |= columnMask(COLUMN_RGB);
+    }
+
+    if (opt.isColorSourceEnabled(opt.COLOR_SOURCE_INTENSITY))
+    {
+        mask |= columnMask(COLUMN_INTENSITY);
+    }
+
+    if (opt.isColorSourceEnabled(opt.COLOR_SOURCE_RETURN_NUMBER) ||
+        opt.isColorSourceEnabled(opt.COLOR_SOURCE_NUMBER_OF_RETURNS) ||
+        opt.isColorSourceEnabled(opt.COLOR_SOURCE_CLASSIFICATION) ||
+        editor->classification().isEnabled())
+    {
+        mask |= columnMask(COLUMN_ATTRIB);
+    }
+
+    if (editor->layers().isEnabled())
+    {
+        mask |= columnMask(COLUMN_LAYER);
+    }
+
+    return mask;
 }
 
-void EditorTile::selectClip(const EditorBase *editor)
+size_t EditorTile::memorySize(Column column) const
 {
-    if (!editor->clipFilter().enabled)
+    switch (column)
     {
-        return;
+        case COLUMN_XYZ:
+            return xyz.capacity() * sizeof(float);
+        case COLUMN_RENDER:
+            return renderXyz.capacity() * sizeof(int16_t) +
+                   renderOrder.capacity() * sizeof(unsigned int);
+        case COLUMN_INTENSITY:
+            return intensity.capacity() * sizeof(float);
+        case COLUMN_RGB:
+            return rgb.capacity() * sizeof(uint8_t);
+        case COLUMN_RGB_OUTPUT:
+            return rgbOutput.capacity() * sizeof(uint8_t);
+        case COLUMN_ATTRIB:
+            return attrib.capacity() * sizeof(Attributes);
+        case COLUMN_GPS_TIME:
+            return gpsTime.capacity() * sizeof(double);
+        case COLUMN_LAYER:
+            return layer.capacity() * sizeof(uint32_t);
+        case COLUMN_COUNT:
+        default:
+            return 0;
     }
+}
 
-    const EditorDataSet &dataSet = editor->dataSet(dataSetId);
+size_t EditorTile::memorySize() const
+{
+    size_t size = view->indices.capacity() * sizeof(unsigned int) +
+                  visible.capacity() * sizeof(uint64_t) +
+                  view->rgba.capacity() * sizeof(uint8_t);
+
+    for (size_t i = 0; i < FILTER_COLOR; i++)
+    {
+        size += visibleFilter[i].capacity() * sizeof(uint64_t);
+    }
+
+    for (size_t i = 0; i < COLUMN_COUNT; i++)
+    {
+        size += memorySize(static_cast<Column>(i));
+    }
+
+    return size;
+}
+
+void EditorTile::readLas(const EditorDataSet &dataSet,
+                         FileLas::Columns &columns,
+                         size_t n)
+{
     const FileIndex::Node *node = dataSet.index.at(tileId);
 
-    // Read L2 index
-    if (index.empty())
+    // Read tile buffer from LAS file
+    FileLas las;
+    las.open(dataSet.path);
+    las.readHeader();
+
+    size_t pointSize = las.header.point_data_record_length;
+    std::vector<uint8_t> buffer;
+    size_t bufferSize = pointSize * n;
+    buffer.resize(bufferSize);
+
+    if (las.header.point_data_compressed)
     {
-        std::string pathIndex = FileIndexBuilder::extension(dataSet.path);
-        index.read(pathIndex, node->offset);
-        index.translate(dataSet.translation);
+        const std::string path = FileIndexBuilder::extension(dataSet.path);
+        FileLasCompression::readNode(buffer.data(), las, path, *node);
+    }
+    else
+    {
+        uint64_t start = node->from * pointSize;
+        las.seek(start + las.header.offset_to_point_data);
+        las.file().read(buffer.data(), bufferSize);
     }
 
-    // Select octants
-    std::vector<FileIndex::Selection> selection;
-    Aabb<double> clipBox = editor->clipFilter().box;
+    // Convert buffer to point data columns
+    las.readPoints(columns, buffer.data(), n);
+}
 
-    index.selectLeaves(selection, clipBox, dataSet.id);
+void EditorTile::readColumns(const EditorDataSet &dataSet,
+                             FileLas::Columns &columns,
+                             size_t n)
+{
+    const FileColumns &file = dataSet.columns;
+    const FileColumns::Node &node = file.at(tileId);
 
-    // Compute upper limit of the number of selected points
-    size_t nSelected = 0;
+    if (node.size != n)
+    {
+        THROW("Columns do not match index of '" + dataSet.path + "'");
+    }
 
-    for (size_t i = 0; i < selection.size(); i++)
+    // Read requested pre-decoded blocks from columns file
+    if (columns.intensity)
     {
-        const FileIndex::Node *nodeL2 = index.at(selection[i].idx);
-        if (!nodeL2)
-        {
-            continue;
-        }
+        file.read(reinterpret_cast<uint8_t *>(columns.intensity),
+                  tileId,
+                  FileColumns::COLUMN_INTENSITY);
+    }
 
-        nSelected += static_cast<size_t>(nodeL2->size);
+    if (columns.rgb)
+    {
+        file.read(reinterpret_cast<uint8_t *>(columns.rgb),
+                  tileId,
+                  FileColumns::COLUMN_COLOR);
     }
 
-    indices.resize(nSelected);
+    if (columns.returnNumber)
+    {
+        file.read(columns.returnNumber,
+                  tileId,
+                  FileColumns::COLUMN_RETURN_NUMBER);
+    }
 
-    // Select points
-    nSelected = 0;
+    if (columns.numberOfReturns)
+    {
+        file.read(columns.numberOfReturns,
+                  tileId,
+                  FileColumns::COLUMN_NUMBER_OF_RETURNS);
+    }
 
-    for (size_t i = 0; i < selection.size(); i++)
+    if (columns.classification)
     {
-        const FileIndex::Node *nodeL2 = index.at(selection[i].idx);
-        if (!nodeL2)
-        {
-            continue;
-        }
+        file.read(columns.classification,
+                  tileId,
+                  FileColumns::COLUMN_CLASSIFICATION);
+    }
 
-        unsigned int nPoints = static_cast<unsigned int>(nodeL2->size);
-        unsigned int from = static_cast<unsigned int>(nodeL2->from);
+    if (columns.userData)
+    {
+        file.read(columns.userData, tileId, FileColumns::COLUMN_USER_DATA);
+    }
 
-        if (selection[i].partial)
-        {
-            // Partial selection, apply clip filter
-            for (unsigned int j = 0; j < nPoints; j++)
-            {
-                unsigned int idx = from + j;
-                double x = xyz[3 * idx + 0];
-                double y = xyz[3 * idx + 1];
-                double z = xyz[3 * idx + 2];
+    if (columns.gpsTime)
+    {
+        file.read(reinterpret_cast<uint8_t *>(columns.gpsTime),
+                  tileId,
+                  FileColumns::COLUMN_GPS_TIME);
+    }
 
-                if (clipBox.isInside(x, y, z))
-                {
-                    indices[nSelected++] = idx;
-                }
-            }
-        }
-        else
-        {
-            // Everything
-            for (unsigned int j = 0; j < nPoints; j++)
-            {
-                indices[nSelected++] = from + j;
-            }
-        }
+    if (columns.userLayer)
+    {
+        file.read(reinterpret_cast<uint8_t *>(columns.userLayer),
+                  tileId,
+                  FileColumns::COLUMN_LAYER);
     }
 
-    indices.resize(nSelected);
+    if (columns.userRgb)
+    {
+        file.read(reinterpret_cast<uint8_t *>(columns.userRgb),
+                  tileId,
+                  FileColumns::COLUMN_USER_COLOR);
+    }
 }
 
-void EditorTile::selectClass(const EditorBase *editor)
+void EditorTile::readPositions(const EditorDataSet &dataSet,
+                               std::vector<float> &positions,
+                               size_t n)
 {
-    const EditorClassification &c = editor->classification();
+    const FileColumns &file = dataSet.columns;
+    const FileColumns::Node &node = file.at(tileId);
 
-    if (!c.isEnabled())
+    if (node.size != n)
+    {
+        THROW("Columns do not match index of '" + dataSet.path + "'");
+    }
+
+    // Positions in columns file are relative to the minimum of the tile
+    file.read(reinterpret_cast<uint8_t *>(positions.data()),
+              tileId,
+              FileColumns::COLUMN_POSITION);
+
+    // Origin and boundary are set by the first load of positions
+    if (resident & (columnMask(COLUMN_XYZ) | columnMask(COLUMN_RENDER)))
     {
         return;
     }
 
-    size_t nSelected = indices.size();
-    size_t nSelectedNew = 0;
+    Aabb<float> box;
+    box.set(positions);
+    origin.set(node.origin[0], node.origin[1], node.origin[2]);
+    boundary.set(origin[0],
+                 origin[1],
+                 origin[2],
+                 origin[0] + static_cast<double>(box.max(0)),
+                 origin[1] + static_cast<double>(box.max(1)),
+                 origin[2] + static_cast<double>(box.max(2)));
+}
+
+bool EditorTile::filter(const EditorBase *editor)
+{
+    const EditorDataSet &dataSet = editor->dataSet(dataSetId);
+    size_t n = static_cast<size_t>(dataSet.index.at(tileId)->size);
+    uint32_t pending = filterPending;
+    filterPending = 0;
+    copyOnWrite();
+
+    // Skip whole tile when its node summary can not match the filters
+    if (!matchesSummary(editor))
+    {
+        visible.assign((n + 63) / 64, 0);
+        view->indices.clear();
+        skipped = true;
+        return false;
+    }
 
-    for (size_t i = 0; i < nSelected; i++)
+    if (skipped)
     {
-        unsigned int idx = indices[i];
+        // Cached results are not valid after the tile was skipped
+        pending = filterMaskAll();
+        filterCached = 0;
+        skipped = false;
+    }
 
-        if (c.isEnabled(attrib[idx].classification))
+    load(editor, columnsRequired(editor));
+    view->rgba.resize(n * 4);
+    uint32_t selection = filterMask(FILTER_CLIP) |
+                         filterMask(FILTER_CLASSIFICATION) |
+                         filterMask(FILTER_LAYERS);
+
+    if (pending & selection)
+    {
+        if ((pending & selection) == selection)
         {
-            if (nSelectedNew != i)
+            // Evaluate all filters in one pass
+            EditorTileFilter tileFilter;
+            for (size_t i = 0; i < FILTER_COLOR; i++)
             {
-                indices[nSelectedNew] = indices[i];
+                setFilter(tileFilter, editor, static_cast<Filter>(i));
+                visibleFilter[i].clear();
+                visibleFilter[i].shrink_to_fit();
             }
-            nSelectedNew++;
+
+            tileFilter.apply(visible,
+                             xyz.data(),
+                             attrib.data(),
+                             layer.data(),
+                             n);
+            filterCached = 0;
+        }
+        else
+        {
+            // Recompute changed filters, reuse cached results of others
+            for (size_t i = 0; i < FILTER_COLOR; i++)
+            {
+                uint32_t mask = filterMask(static_cast<Filter>(i));
+                if (!(pending & mask) && (filterCached & mask))
+                {
+                    continue;
+                }
+
+                EditorTileFilter tileFilter;
+                if (setFilter(tileFilter, editor, static_cast<Filter>(i)))
+                {
+                    tileFilter.apply(visibleFilter[i],
+                                     xyz.data(),
+                                     attrib.data(),
+                                     layer.data(),
+                                     n);
+                }
+                else
+                {
+                    // Disabled filter selects all points
+                    visibleFilter[i].clear();
+                }
+                filterCached |= mask;
+            }
+
+            EditorTileFilter::combine(visible, visibleFilter, FILTER_COLOR, n);
+        }
+
+        if (renderOrder.size() == n)
+        {
+            EditorTileFilter::compact(view->indices, visible, renderOrder);
+        }
+        else
+        {
+            EditorTileFilter::compact(view->indices, visible, n);
+        }
+
+        // Plugin filters modify colors of selected points
+        if (editor->hasFilterEnabled())
+        {
+            pending |= filterMask(FILTER_COLOR);
         }
     }
 
-    indices.resize(nSelectedNew);
+    if (pending & filterMask(FILTER_COLOR))
+    {
+        setPointColor(editor);
+    }
+
+    return (pending & filterMask(FILTER_COLOR)) != 0;
 }
 
-void EditorTile::selectLayers(const EditorBase *editor)
+bool EditorTile::matchesSummary(const EditorBase *editor) const
 {
-    const EditorLayers &la = editor->layers();
-
-    if (!la.isEnabled())
+    const EditorDataSet &dataSet = editor->dataSet(dataSetId);
+    const FileIndex::Node *node = dataSet.index.at(tileId);
+    const FileIndex::Summary *summary = dataSet.index.summary(node);
+    if (!summary)
     {
-        return;
+        return true;
     }
 
-    size_t nSelected = indices.size();
-    size_t nSelectedNew = 0;
+    EditorTileFilter tileFilter;
+    setFilter(tileFilter, editor, FILTER_CLASSIFICATION);
+    setFilter(tileFilter, editor, FILTER_LAYERS);
+
+    return tileFilter.matches(*summary);
+}
+
+bool EditorTile::setFilter(EditorTileFilter &tileFilter,
+                           const EditorBase *editor,
+                           Filter filter) const
+{
+    const EditorDataSet &dataSet = editor->dataSet(dataSetId);
+    const FileIndex::Node *node = dataSet.index.at(tileId);
+    const FileIndex::Summary *summary = dataSet.index.summary(node);
 
-    for (size_t i = 0; i < nSelected; i++)
+    switch (filter)
     {
-        unsigned int idx = indices[i];
+        case FILTER_CLIP:
+            if (editor->clipFilter().enabled)
+            {
+                // Clip box is inverse transformed to the data set
+                Aabb<double> clipBox = editor->clipFilter().box;
+                clipBox.translate(-dataSet.translation);
 
-        if (la.isIdEnabled(layer[idx]))
-        {
-            if (nSelectedNew != i)
+                if (!boundary.isInside(clipBox))
+                {
+                    tileFilter.setClipBox(clipBox, origin);
+                    return true;
+                }
+            }
+            return false;
+
+        case FILTER_CLASSIFICATION:
+            if (editor->classification().isEnabled())
             {
-                indices[nSelectedNew] = indices[i];
+                // Node summary may show that all points are selected
+                EditorTileFilter classFilter;
+                classFilter.setClassification(editor->classification());
+                if (summary && classFilter.selectsAll(*summary))
+                {
+                    return false;
+                }
+
+                tileFilter.setClassification(editor->classification());
+                return true;
             }
-            nSelectedNew++;
-        }
-    }
+            return false;
+
+        case FILTER_LAYERS:
+            if (editor->layers().isEnabled())
+            {
+                EditorTileFilter layerFilter;
+                layerFilter.setLayers(editor->layers());
+                if (summary && layerFilter.selectsAll(*summary))
+                {
+                    return false;
+                }
+
+                tileFilter.setLayers(editor->layers());
+                return true;
+            }
+            return false;
 
-    indices.resize(nSelectedNew);
+        case FILTER_COLOR:
+        case FILTER_COUNT:
+        default:
+            return false;
+    }
 }
 
 void EditorTile::setPointColor(const EditorBase *editor)
 {
     const EditorSettings::View &opt = editor->settings().view();
-    float r = opt.pointColorRed();
-    float g = opt.pointColorGreen();
-    float b = opt.pointColorBlue();
-
-    size_t n = intensity.size();
+    const Vector3<float> color(opt.pointColorRed(),
+                               opt.pointColorGreen(),
+                               opt.pointColorBlue());
+
+    bool useColor = opt.isColorSourceEnabled(opt.COLOR_SOURCE_COLOR);
+    bool useIntensity = opt.isColorSourceEnabled(opt.COLOR_SOURCE_INTENSITY);
+    bool useReturnNumber =
+        opt.isColorSourceEnabled(opt.COLOR_SOURCE_RETURN_NUMBER);
+    bool useNumberOfReturns =
+        opt.isColorSourceEnabled(opt.COLOR_SOURCE_NUMBER_OF_RETURNS);
+    bool useClassification =
+        opt.isColorSourceEnabled(opt.COLOR_SOURCE_CLASSIFICATION);
+
+    const std::vector<Vector3<float>> &palIntensity =
+        ColorPalette::BlueCyanYellowRed256;
+    const std::vector<Vector3<float>> &palReturns =
+        ColorPalette::BlueCyanGreenYellowRed16;
+    const std::vector<Vector3<float>> &palClassification =
+        ColorPalette::Classification;
+
+    // Color sources are combined in floating point and stored once
+    const size_t max16 = 15;
+    const size_t max256 = 255;
+    const float scaleU8 = 1.0F / 255.0F;
+    size_t n = view->rgba.size() / 4;
 
     for (size_t i = 0; i < n; i++)
     {
-        view.rgb[i * 3 + 0] = r;
-        view.rgb[i * 3 + 1] = g;
-        view.rgb[i * 3 + 2] = b;
-    }
+        Vector3<float> c = color;
 
-    if (opt.isColorSourceEnabled(opt.COLOR_SOURCE_COLOR))
-    {
-        for (size_t i = 0; i < (n * 3); i++)
+        if (useColor)
         {
-            view.rgb[i] *= rgb[i];
+            c[0] *= static_cast<float>(rgb[i * 3 + 0]) * scaleU8;
+            c[1] *= static_cast<float>(rgb[i * 3 + 1]) * scaleU8;
+            c[2] *= static_cast<float>(rgb[i * 3 + 2]) * scaleU8;
         }
-    }
 
-    if (opt.isColorSourceEnabled(opt.COLOR_SOURCE_INTENSITY))
-    {
-        // for (size_t i = 0; i < n; i++)
-        // {
-        //     view.rgb[i * 3 + 0] *= intensity[i];
-        //     view.rgb[i * 3 + 1] *= intensity[i];
-        //     view.rgb[i * 3 + 2] *= intensity[i];
-        // }
-
-        for (size_t i = 0; i < n; i++)
+        if (useIntensity)
         {
-            setColor(i,
-                     static_cast<size_t>(intensity[i] * 255.0F),
-                     255,
-                     ColorPalette::BlueCyanYellowRed256);
+            size_t value = static_cast<size_t>(intensity[i] * 255.0F);
+            c = c * palIntensity[std::min(value, max256)];
         }
-    }
 
-    if (opt.isColorSourceEnabled(opt.COLOR_SOURCE_RETURN_NUMBER))
-    {
-        for (size_t i = 0; i < n; i++)
+        if (useReturnNumber)
         {
-            setColor(i,
-                     attrib[i].returnNumber,
-                     15,
-                     ColorPalette::BlueCyanGreenYellowRed16);
+            size_t value = attrib[i].returnNumber;
+            c = c * palReturns[std::min(value, max16)];
         }
-    }
 
-    if (opt.isColorSourceEnabled(opt.COLOR_SOURCE_NUMBER_OF_RETURNS))
-    {
-        for (size_t i = 0; i < n; i++)
+        if (useNumberOfReturns)
         {
-            setColor(i,
-                     attrib[i].numberOfReturns,
-                     15,
-                     ColorPalette::BlueCyanGreenYellowRed16);
+            size_t value = attrib[i].numberOfReturns;
+            c = c * palReturns[std::min(value, max16)];
         }
-    }
 
-    if (opt.isColorSourceEnabled(opt.COLOR_SOURCE_CLASSIFICATION))
-    {
-        for (size_t i = 0; i < n; i++)
+        if (useClassification)
         {
-            setColor(i,
-                     attrib[i].classification,
-                     15,
-                     ColorPalette::Classification);
+            size_t value = attrib[i].classification;
+            c = c * palClassification[std::min(value, max16)];
         }
-    }
-}
 
-void EditorTile::setColor(size_t idx,
-                          size_t value,
-                          size_t max,
-                          const std::vector<Vector3<float>> &pal)
-{
-    if (value > max)
-    {
-        value = max;
+        view->setColor(i, c[0], c[1], c[2]);
     }
-
-    view.rgb[idx * 3 + 0] *= pal[value][0];
-    view.rgb[idx * 3 + 1] *= pal[value][1];
-    view.rgb[idx * 3 + 2] *= pal[value][2];
 }
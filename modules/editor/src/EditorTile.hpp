@@ -24,14 +24,46 @@
 
 #include <Aabb.hpp>
 #include <FileIndex.hpp>
+#include <FileLas.hpp>
 #include <Vector3.hpp>
+#include <memory>
 
 class EditorBase;
+class EditorDataSet;
+class EditorTileFilter;
 
 /** Editor Tile. */
 class EditorTile
 {
 public:
+    /** Editor Tile Column.
+        Point data columns are loaded on demand.
+    */
+    enum Column
+    {
+        COLUMN_XYZ,        /**< xyz */
+        COLUMN_RENDER,     /**< renderXyz, renderOrder */
+        COLUMN_INTENSITY,  /**< intensity */
+        COLUMN_RGB,        /**< rgb */
+        COLUMN_RGB_OUTPUT, /**< rgbOutput */
+        COLUMN_ATTRIB,     /**< attrib */
+        COLUMN_GPS_TIME,   /**< gpsTime */
+        COLUMN_LAYER,      /**< layer */
+        COLUMN_COUNT
+    };
+
+    /** Editor Tile Filter.
+        Filters are recomputed only when their input has changed.
+    */
+    enum Filter
+    {
+        FILTER_CLIP,           /**< Clip box */
+        FILTER_CLASSIFICATION, /**< Classification */
+        FILTER_LAYERS,         /**< Layers */
+        FILTER_COLOR,          /**< Point colors and plugin filters */
+        FILTER_COUNT
+    };
+
     /** Editor Tile Attributes. */
     struct Attributes
     {
@@ -45,9 +77,35 @@ public:
     /**@{*/
     /** Point coordinates.
         The data are stored as [x0, y0, z0, x1, y1, ...].
-        These are actual X, Y, or Z coordinates after scaling and offset.
+        These are X, Y, and Z coordinates relative to the tile origin.
+        Actual coordinates are origin + xyz. Loaded only for filters which
+        need full precision, other readers use renderPosition().
      */
-    std::vector<double> xyz;
+    std::vector<float> xyz;
+
+    /** Quantized point coordinates for rendering.
+        The data are stored as [x0, y0, z0, x1, y1, ...]. The values span
+        the tile boundary, render coordinates are renderOrigin +
+        renderScale * renderXyz. Built by the loader from point coordinates
+        which are not kept unless COLUMN_XYZ is requested.
+    */
+    std::vector<int16_t> renderXyz;
+    Vector3<double> renderOrigin; /**< Relative to the tile origin. */
+    Vector3<double> renderScale;
+
+    /** Progressive order of points for rendering.
+        Any prefix of this order is a spatially uniform subsample of the
+        tile, visible points are listed in this order. Built together
+        with renderXyz.
+    */
+    std::vector<unsigned int> renderOrder;
+
+    /** Tile origin.
+        Minimum point coordinates in data set coordinates. The data set
+        translation is applied at render and query time, world coordinates
+        are dataSet.translation + origin + xyz.
+    */
+    Vector3<double> origin;
 
     /** Pulse return magnitude.
         The data are stored as [i0, i1, ...].
@@ -57,18 +115,18 @@ public:
 
     /** Red, Green, and Blue image channels.
         The data are stored as [r0, g0, b0, r1, g1, ...].
-        Color values are in range from 0 (zero intensity) to 1 (full intensity).
-        When the input data set has no colors, then the colors in this vector
-        are set to full intensity.
+        Color values are in range from 0 (zero intensity) to 255 (full
+        intensity). When the input data set has no colors, then the colors
+        in this vector are set to full intensity.
     */
-    std::vector<float> rgb;
+    std::vector<uint8_t> rgb;
 
     /** Red, Green, and Blue output colors.
         The data are stored as [r0, g0, b0, r1, g1, ...].
-        Color values are in range from 0 (zero intensity) to 1 (full intensity).
-        This value is stored in Point Data Record extra bytes.
+        Color values are in range from 0 (zero intensity) to 255 (full
+        intensity). This value is stored in Point Data Record extra bytes.
     */
-    std::vector<float> rgbOutput;
+    std::vector<uint8_t> rgbOutput;
 
     /** Point attributes. */
     std::vector<Attributes> attrib;
@@ -83,68 +141,96 @@ public:
     /**@}*/
 
     // Bounding box
-    Aabb<double> boundary;
-
-    // Index
-    FileIndex index;
-    std::vector<unsigned int> indices;
+    Aabb<double> boundary; /**< In data set coordinates. */
 
-    // Data
-    std::vector<double> xyzBase;
+    // Selection
+    std::vector<uint64_t> visible; /**< Visibility bit mask, 1 bit/point. */
+    std::vector<uint64_t> visibleFilter[FILTER_COLOR]; /**< Per filter. */
 
     // Tile
     size_t dataSetId;
     size_t tileId;
 
+    // Columns
+    uint32_t resident; /**< Bit mask of resident columns. */
+
     // State
     bool loaded;
-    bool transformed;
-    bool filtered;
-    bool filteredClass;
+    uint32_t filterPending; /**< Bit mask of filters to recompute. */
+    uint32_t filterCached;  /**< Bit mask of valid visibleFilter. */
+    bool skipped;           /**< Skipped by node summary. */
     bool modified;
+    bool loading; /**< Owned by the loader, other fields are not valid. */
 
-    /** Editor Tile Visualization. */
+    /** Editor Tile Visualization, shared by all viewports.
+        The view is published as an immutable snapshot which is drawn
+        without the editor lock. A published view is copied on write and
+        stays drawn until publish() replaces it. Point coordinates do not
+        change after they are loaded.
+    */
     class View
     {
     public:
-        std::vector<float> xyz;
-        std::vector<float> rgb;
-
-        Aabb<float> boundary;
+        std::vector<unsigned int> indices; /**< Visible points. */
+        std::vector<uint8_t> rgba;         /**< [r0, g0, b0, a0, r1, ...] */
 
         View();
         ~View();
 
-        void resetFrame();
-        void nextFrame();
-        bool isStarted() const;
-        bool isFinished() const;
-
-    protected:
-        size_t renderStep;
-        size_t renderStepCount;
+        void setColor(size_t idx, float r, float g, float b);
+        void multiplyColor(size_t idx, const Vector3<float> &color);
     };
 
-    View view;
+    std::shared_ptr<View> view;
 
     EditorTile();
     ~EditorTile();
 
     void read(const EditorBase *editor);
-    void transform(const EditorBase *editor);
-    void filter(const EditorBase *editor);
+    void load(const EditorBase *editor, uint32_t mask);
+    void quantize(const std::vector<float> &positions);
+    Vector3<double> renderPosition(size_t idx) const;
+    bool filter(const EditorBase *editor);
+
+    bool isFiltered() const { return !loading && loaded && !filterPending; }
+
+    void publish();
+    void copyOnWrite();
+    std::shared_ptr<const View> snapshot() const;
+
+    bool hasColumn(Column column) const
+    {
+        return (resident & columnMask(column)) != 0;
+    }
+    static uint32_t columnMask(Column column) { return 1U << column; }
+    static uint32_t columnsRequired(const EditorBase *editor);
+
+    static uint32_t filterMask(Filter filter) { return 1U << filter; }
+    static uint32_t filterMaskAll() { return (1U << FILTER_COUNT) - 1U; }
 
-    bool renderMore() const;
+    size_t memorySize() const;
+    size_t memorySize(Column column) const;
 
 protected:
-    void selectClip(const EditorBase *editor);
-    void selectClass(const EditorBase *editor);
-    void selectLayers(const EditorBase *editor);
+    std::shared_ptr<const View> snapshot_;
+    bool shared_; /**< The view was published. */
+
+    void readLas(const EditorDataSet &dataSet,
+                 FileLas::Columns &columns,
+                 size_t n);
+    void readColumns(const EditorDataSet &dataSet,
+                     FileLas::Columns &columns,
+                     size_t n);
+    void readPositions(const EditorDataSet &dataSet,
+                       std::vector<float> &positions,
+                       size_t n);
+    void sortRenderOrder();
+
+    bool matchesSummary(const EditorBase *editor) const;
+    bool setFilter(EditorTileFilter &tileFilter,
+                   const EditorBase *editor,
+                   Filter filter) const;
     void setPointColor(const EditorBase *editor);
-    void setColor(size_t idx,
-                  size_t value,
-                  size_t max,
-                  const std::vector<Vector3<float>> &pal);
 };
 
 #endif /* EDITOR_TILE_HPP */
@@ -0,0 +1,425 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/** @file EditorTileFilter.cpp */
+
+#include <EditorClassification.hpp>
+#include <EditorLayers.hpp>
+#include <EditorTileFilter.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#define EDITOR_TILE_FILTER_BLOCK 64
+#define EDITOR_TILE_FILTER_LAYER_TABLE_MAX 65536
+
+/** Index of the lowest set bit by de Bruijn multiplication. */
+static unsigned int lowestBit(uint64_t word)
+{
+    static const unsigned int table[64] = {
+        0,  1,  48, 2,  57, 49, 28, 3,  61, 58, 50, 42, 38, 29, 17, 4,
+        62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12, 5,
+        63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+        46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9,  13, 8,  7,  6};
+
+    uint64_t isolated = word & (~word + 1);
+    return table[(isolated * 0x03F79D71B4CB0A89ULL) >> 58];
+}
+
+EditorTileFilter::EditorTileFilter()
+{
+    clear();
+}
+
+void EditorTileFilter::clear()
+{
+    clip_ = false;
+    for (size_t i = 0; i < 3; i++)
+    {
+        clipMin_[i] = 0;
+        clipMax_[i] = 0;
+    }
+
+    class_ = false;
+    classTable_.fill(1);
+
+    layer_ = false;
+    layerTable_.clear();
+    layerIds_.clear();
+}
+
+void EditorTileFilter::setClipBox(const Aabb<double> &box,
+                                  const Vector3<double> &origin)
+{
+    // Round the box outwards to float so that comparing float positions
+    // gives the same result as comparing origin + position in double
+    const float inf = std::numeric_limits<float>::infinity();
+
+    for (size_t i = 0; i < 3; i++)
+    {
+        double min = box.min(i) - origin[i];
+        double max = box.max(i) - origin[i];
+
+        clipMin_[i] = static_cast<float>(min);
+        if (static_cast<double>(clipMin_[i]) < min)
+        {
+            clipMin_[i] = std::nextafter(clipMin_[i], inf);
+        }
+
+        clipMax_[i] = static_cast<float>(max);
+        if (static_cast<double>(clipMax_[i]) > max)
+        {
+            clipMax_[i] = std::nextafter(clipMax_[i], -inf);
+        }
+    }
+
+    clip_ = true;
+}
+
+void EditorTileFilter::setClassification(
+    const EditorClassification &classification)
+{
+    classTable_.fill(0);
+
+    size_t n = std::min(classification.size(), classTable_.size());
+    for (size_t i = 0; i < n; i++)
+    {
+        if (classification.isEnabled(i))
+        {
+            classTable_[i] = 1;
+        }
+    }
+
+    class_ = true;
+}
+
+void EditorTileFilter::setLayers(const EditorLayers &layers)
+{
+    // Identifiers come from the project, the table is bounded in size
+    const size_t tableMax = EDITOR_TILE_FILTER_LAYER_TABLE_MAX;
+    size_t max = 0;
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        if (layers.isEnabled(i))
+        {
+            max = std::max(max, std::min(layers.id(i) + 1, tableMax));
+        }
+    }
+
+    layerTable_.clear();
+    layerTable_.resize(max + 1, 0);
+    layerIds_.clear();
+
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        if (layers.isEnabled(i))
+        {
+            size_t id = layers.id(i);
+            if (id < tableMax)
+            {
+                layerTable_[id] = 1;
+            }
+            else
+            {
+                layerIds_.push_back(static_cast<uint32_t>(id));
+            }
+        }
+    }
+
+    std::sort(layerIds_.begin(), layerIds_.end());
+    layerIds_.erase(std::unique(layerIds_.begin(), layerIds_.end()),
+                    layerIds_.end());
+
+    layer_ = true;
+}
+
+bool EditorTileFilter::isLayerIdEnabled(uint32_t id) const
+{
+    if (static_cast<size_t>(id) + 1 < layerTable_.size())
+    {
+        return layerTable_[id] != 0;
+    }
+
+    return std::binary_search(layerIds_.begin(), layerIds_.end(), id);
+}
+
+bool EditorTileFilter::matches(const FileIndex::Summary &summary) const
+{
+    if (class_)
+    {
+        bool found = false;
+        for (size_t i = 0; i < classTable_.size() && !found; i++)
+        {
+            found = classTable_[i] && summary.hasClass(i);
+        }
+
+        if (!found)
+        {
+            return false;
+        }
+    }
+
+    if (layer_)
+    {
+        // Enabled layer identifiers are below the size of the table or
+        // listed in sorted order
+        size_t last = layerTable_.size() - 1;
+        size_t max = std::min(static_cast<size_t>(summary.layerMax), last);
+        bool found = false;
+        for (size_t i = summary.layerMin; i < max + 1 && !found; i++)
+        {
+            found = layerTable_[i] != 0;
+        }
+
+        if (!found)
+        {
+            auto it = std::lower_bound(layerIds_.begin(),
+                                       layerIds_.end(),
+                                       summary.layerMin);
+            found = it != layerIds_.end() && *it <= summary.layerMax;
+        }
+
+        if (!found)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool EditorTileFilter::selectsAll(const FileIndex::Summary &summary) const
+{
+    if (class_)
+    {
+        for (size_t i = 0; i < classTable_.size(); i++)
+        {
+            if (!classTable_[i] && summary.hasClass(i))
+            {
+                return false;
+            }
+        }
+    }
+
+    if (layer_)
+    {
+        // Identifiers beyond the table are all enabled when each of them
+        // is listed
+        size_t last = layerTable_.size() - 1;
+        size_t min = summary.layerMin;
+        size_t max = summary.layerMax;
+        for (size_t i = min; i < std::min(max + 1, last); i++)
+        {
+            if (!layerTable_[i])
+            {
+                return false;
+            }
+        }
+
+        if (max >= last && min <= max)
+        {
+            size_t from = std::max(min, last);
+            auto begin = std::lower_bound(layerIds_.begin(),
+                                          layerIds_.end(),
+                                          static_cast<uint32_t>(from));
+            auto end = std::upper_bound(layerIds_.begin(),
+                                        layerIds_.end(),
+                                        summary.layerMax);
+            size_t count = static_cast<size_t>(end - begin);
+            if (count != max - from + 1)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void EditorTileFilter::apply(std::vector<uint64_t> &mask,
+                             const float *xyz,
+                             const EditorTile::Attributes *attrib,
+                             const uint32_t *layer,
+                             size_t n) const
+{
+    const size_t block = EDITOR_TILE_FILTER_BLOCK;
+    mask.resize((n + block - 1) / block);
+
+    // Branch-free predicates over fixed size blocks, the inner loops
+    // are vectorized by the compiler
+    uint8_t visible[EDITOR_TILE_FILTER_BLOCK];
+    const uint32_t layerLast =
+        static_cast<uint32_t>(layerTable_.empty() ? 0 : layerTable_.size() - 1);
+
+    for (size_t w = 0; w < mask.size(); w++)
+    {
+        size_t from = w * block;
+        size_t m = std::min(block, n - from);
+
+        for (size_t j = 0; j < m; j++)
+        {
+            visible[j] = 1;
+        }
+
+        if (clip_)
+        {
+            const float *p = xyz + from * 3;
+            for (size_t j = 0; j < m; j++)
+            {
+                float x = p[j * 3 + 0];
+                float y = p[j * 3 + 1];
+                float z = p[j * 3 + 2];
+                bool inside = (x >= clipMin_[0]) & (x <= clipMax_[0]) &
+                              (y >= clipMin_[1]) & (y <= clipMax_[1]) &
+                              (z >= clipMin_[2]) & (z <= clipMax_[2]);
+                visible[j] = static_cast<uint8_t>(visible[j] & inside);
+            }
+        }
+
+        if (class_)
+        {
+            const EditorTile::Attributes *a = attrib + from;
+            for (size_t j = 0; j < m; j++)
+            {
+                uint8_t c = classTable_[a[j].classification];
+                visible[j] = static_cast<uint8_t>(visible[j] & c);
+            }
+        }
+
+        if (layer_)
+        {
+            const uint32_t *l = layer + from;
+            if (layerIds_.empty())
+            {
+                for (size_t j = 0; j < m; j++)
+                {
+                    uint8_t e = layerTable_[std::min(l[j], layerLast)];
+                    visible[j] = static_cast<uint8_t>(visible[j] & e);
+                }
+            }
+            else
+            {
+                // Identifiers beyond the table are searched
+                for (size_t j = 0; j < m; j++)
+                {
+                    uint8_t e = isLayerIdEnabled(l[j]) ? 1 : 0;
+                    visible[j] = static_cast<uint8_t>(visible[j] & e);
+                }
+            }
+        }
+
+        uint64_t word = 0;
+        for (size_t j = 0; j < m; j++)
+        {
+            word |= static_cast<uint64_t>(visible[j]) << j;
+        }
+        mask[w] = word;
+    }
+}
+
+void EditorTileFilter::combine(std::vector<uint64_t> &mask,
+                               const std::vector<uint64_t> *masks,
+                               size_t count,
+                               size_t n)
+{
+    // All points are visible
+    mask.assign((n + 63) / 64, ~0ULL);
+    if (n % 64)
+    {
+        mask.back() = (1ULL << (n % 64)) - 1;
+    }
+
+    // Empty masks are disabled filters
+    for (size_t i = 0; i < count; i++)
+    {
+        if (masks[i].size() == mask.size())
+        {
+            for (size_t w = 0; w < mask.size(); w++)
+            {
+                mask[w] &= masks[i][w];
+            }
+        }
+    }
+}
+
+size_t EditorTileFilter::count(const std::vector<uint64_t> &mask)
+{
+    size_t n = 0;
+    for (size_t w = 0; w < mask.size(); w++)
+    {
+        uint64_t word = mask[w];
+        while (word)
+        {
+            word &= word - 1;
+            n++;
+        }
+    }
+    return n;
+}
+
+void EditorTileFilter::compact(std::vector<unsigned int> &indices,
+                               const std::vector<uint64_t> &mask,
+                               size_t n)
+{
+    indices.resize(n);
+
+    size_t nSelected = 0;
+    for (size_t w = 0; w < mask.size(); w++)
+    {
+        uint64_t word = mask[w];
+        unsigned int base = static_cast<unsigned int>(w * 64);
+
+        if (word == ~0ULL)
+        {
+            for (unsigned int j = 0; j < 64; j++)
+            {
+                indices[nSelected++] = base + j;
+            }
+            continue;
+        }
+
+        while (word)
+        {
+            indices[nSelected++] = base + lowestBit(word);
+            word &= word - 1;
+        }
+    }
+
+    indices.resize(nSelected);
+}
+
+void EditorTileFilter::compact(std::vector<unsigned int> &indices,
+                               const std::vector<uint64_t> &mask,
+                               const std::vector<unsigned int> &order)
+{
+    // Selected points keep the given order
+    indices.resize(order.size());
+
+    size_t nSelected = 0;
+    for (const auto &idx : order)
+    {
+        if ((mask[idx >> 6] >> (idx & 63U)) & 1U)
+        {
+            indices[nSelected++] = idx;
+        }
+    }
+
+    indices.resize(nSelected);
+}
@@ -0,0 +1,95 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/** @file EditorTileFilter.hpp */
+
+#ifndef EDITOR_TILE_FILTER_HPP
+#define EDITOR_TILE_FILTER_HPP
+
+#include <Aabb.hpp>
+#include <EditorTile.hpp>
+#include <FileIndex.hpp>
+#include <Vector3.hpp>
+#include <array>
+#include <vector>
+
+class EditorClassification;
+class EditorLayers;
+
+/** Editor Tile Filter.
+    Evaluates clip box, classification and layer filters for each point
+    of a tile in a single pass. The result is a visibility bit mask with
+    one bit per point, bit (i % 64) of word (i / 64) is point i.
+*/
+class EditorTileFilter
+{
+public:
+    EditorTileFilter();
+
+    void clear();
+
+    void setClipBox(const Aabb<double> &box, const Vector3<double> &origin);
+    void setClassification(const EditorClassification &classification);
+    void setLayers(const EditorLayers &layers);
+
+    bool isEnabled() const { return clip_ || class_ || layer_; }
+
+    // Node summaries of classification and layers
+    bool matches(const FileIndex::Summary &summary) const;
+    bool selectsAll(const FileIndex::Summary &summary) const;
+
+    void apply(std::vector<uint64_t> &mask,
+               const float *xyz,
+               const EditorTile::Attributes *attrib,
+               const uint32_t *layer,
+               size_t n) const;
+
+    static void combine(std::vector<uint64_t> &mask,
+                        const std::vector<uint64_t> *masks,
+                        size_t count,
+                        size_t n);
+    static size_t count(const std::vector<uint64_t> &mask);
+    static void compact(std::vector<unsigned int> &indices,
+                        const std::vector<uint64_t> &mask,
+                        size_t n);
+    static void compact(std::vector<unsigned int> &indices,
+                        const std::vector<uint64_t> &mask,
+                        const std::vector<unsigned int> &order);
+
+protected:
+    // Clip box relative to tile origin
+    bool clip_;
+    float clipMin_[3];
+    float clipMax_[3];
+
+    // Classification lookup table
+    bool class_;
+    std::array<uint8_t, 256> classTable_;
+
+    // Layer lookup table, the last entry is always zero. Enabled layer
+    // identifiers which do not fit to the table are sorted in layerIds_.
+    bool layer_;
+    std::vector<uint8_t> layerTable_;
+    std::vector<uint32_t> layerIds_;
+
+    bool isLayerIdEnabled(uint32_t id) const;
+};
+
+#endif /* EDITOR_TILE_FILTER_HPP */
@@ -0,0 +1,308 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/** @file EditorTileStore.cpp */
+
+#include <EditorTileStore.hpp>
+#include <functional>
+
+EditorTileStore::Statistics::Statistics()
+    : hits(0),
+      misses(0),
+      evictions(0),
+      residentTiles(0),
+      residentBytes(0),
+      pinnedTiles(0),
+      probationTiles(0),
+      budget(static_cast<size_t>(-1)),
+      prefetchTiles(0),
+      prefetchHits(0),
+      prefetchCancelled(0),
+      prefetchWastedTiles(0),
+      prefetchWastedBytes(0)
+{
+}
+
+EditorTileStore::EditorTileStore()
+{
+    reset();
+}
+
+EditorTileStore::~EditorTileStore()
+{
+}
+
+void EditorTileStore::clear()
+{
+    entries_.clear();
+
+    size_t budget = stats_.budget;
+    reset();
+    stats_.budget = budget;
+}
+
+void EditorTileStore::reset()
+{
+    Entry *lists[2] = {&lru_, &probation_};
+    for (Entry *list : lists)
+    {
+        list->bytes = 0;
+        list->pinCount = 0;
+        list->useCount = 0;
+        list->prefetched = false;
+        list->prev = list;
+        list->next = list;
+    }
+
+    stats_ = Statistics();
+}
+
+void EditorTileStore::reload(uint32_t filters)
+{
+    for (auto &it : entries_)
+    {
+        it.second.tile->filterPending |= filters;
+    }
+}
+
+void EditorTileStore::setBudget(size_t bytes)
+{
+    stats_.budget = bytes;
+    evict();
+}
+
+std::shared_ptr<EditorTile> EditorTileStore::pin(const Key &key)
+{
+    auto search = entries_.find(key);
+    if (search != entries_.end())
+    {
+        Entry *entry = &search->second;
+        if (entry->prefetched)
+        {
+            entry->prefetched = false;
+            stats_.prefetchHits++;
+        }
+        pin(*entry->tile);
+        entry->useCount++;
+        stats_.hits++;
+        return entry->tile;
+    }
+
+    Entry &entry = create(key);
+    entry.useCount = 1;
+    stats_.misses++;
+
+    return entry.tile;
+}
+
+std::shared_ptr<EditorTile> EditorTileStore::prefetch(const Key &key)
+{
+    if (entries_.find(key) != entries_.end())
+    {
+        return nullptr;
+    }
+
+    Entry &entry = create(key);
+    entry.prefetched = true;
+    stats_.prefetchTiles++;
+
+    return entry.tile;
+}
+
+EditorTileStore::Entry &EditorTileStore::create(const Key &key)
+{
+    std::shared_ptr<EditorTile> tile = std::make_shared<EditorTile>();
+    tile->dataSetId = key.dataSetId;
+    tile->tileId = key.tileId;
+    tile->loaded = false;
+
+    Entry &entry = entries_[key];
+    entry.tile = tile;
+    entry.bytes = tile->memorySize();
+    entry.pinCount = 1;
+    entry.useCount = 0;
+    entry.prefetched = false;
+    entry.prev = nullptr;
+    entry.next = nullptr;
+
+    stats_.residentTiles++;
+    stats_.residentBytes += entry.bytes;
+    stats_.pinnedTiles++;
+
+    return entry;
+}
+
+void EditorTileStore::pin(const EditorTile &tile)
+{
+    auto search = entries_.find({tile.dataSetId, tile.tileId});
+    if (search == entries_.end())
+    {
+        return;
+    }
+
+    Entry *entry = &search->second;
+    if (entry->pinCount == 0)
+    {
+        if (entry->useCount <= 1)
+        {
+            stats_.probationTiles--;
+        }
+        unlink(entry);
+        stats_.pinnedTiles++;
+    }
+    entry->pinCount++;
+}
+
+void EditorTileStore::unpin(const EditorTile &tile)
+{
+    auto search = entries_.find({tile.dataSetId, tile.tileId});
+    if (search == entries_.end() || search->second.pinCount == 0)
+    {
+        return;
+    }
+
+    Entry *entry = &search->second;
+    entry->pinCount--;
+    if (entry->pinCount == 0)
+    {
+        stats_.pinnedTiles--;
+
+        // Loading was cancelled
+        if (!entry->tile->loaded)
+        {
+            if (entry->prefetched)
+            {
+                stats_.prefetchCancelled++;
+            }
+            erase(entry);
+            return;
+        }
+
+        // Tiles used once are not admitted to the main list
+        if (entry->useCount <= 1)
+        {
+            stats_.probationTiles++;
+            link(&probation_, entry);
+        }
+        else
+        {
+            link(&lru_, entry);
+        }
+
+        evict();
+    }
+}
+
+void EditorTileStore::update(const EditorTile &tile)
+{
+    auto search = entries_.find({tile.dataSetId, tile.tileId});
+    if (search == entries_.end())
+    {
+        return;
+    }
+
+    Entry *entry = &search->second;
+    size_t bytes = tile.memorySize();
+    stats_.residentBytes = stats_.residentBytes - entry->bytes + bytes;
+    entry->bytes = bytes;
+
+    evict();
+}
+
+void EditorTileStore::link(Entry *list, Entry *entry)
+{
+    entry->prev = list;
+    entry->next = list->next;
+    list->next->prev = entry;
+    list->next = entry;
+}
+
+void EditorTileStore::unlink(Entry *entry)
+{
+    entry->prev->next = entry->next;
+    entry->next->prev = entry->prev;
+    entry->prev = nullptr;
+    entry->next = nullptr;
+}
+
+void EditorTileStore::evict()
+{
+    // Pinned tiles are not in the lists, the budget may be exceeded by them
+    while (stats_.residentBytes > stats_.budget)
+    {
+        Entry *entry;
+        if (probation_.prev != &probation_)
+        {
+            entry = probation_.prev;
+            stats_.probationTiles--;
+        }
+        else if (lru_.prev != &lru_)
+        {
+            entry = lru_.prev;
+        }
+        else
+        {
+            break;
+        }
+
+        unlink(entry);
+
+        if (entry->prefetched)
+        {
+            stats_.prefetchWastedTiles++;
+            stats_.prefetchWastedBytes += entry->bytes;
+        }
+        stats_.evictions++;
+
+        erase(entry);
+    }
+}
+
+void EditorTileStore::erase(Entry *entry)
+{
+    stats_.residentBytes -= entry->bytes;
+    stats_.residentTiles--;
+
+    Key key = {entry->tile->dataSetId, entry->tile->tileId};
+    entries_.erase(key);
+}
+
+size_t EditorTileStore::memorySize(EditorTile::Column column) const
+{
+    size_t size = 0;
+
+    for (const auto &it : entries_)
+    {
+        size += it.second.tile->memorySize(column);
+    }
+
+    return size;
+}
+
+bool EditorTileStore::Key::operator==(const Key &rhs) const
+{
+    return dataSetId == rhs.dataSetId && tileId == rhs.tileId;
+}
+
+size_t EditorTileStore::KeyHash::operator()(const Key &key) const
+{
+    uint64_t h = (static_cast<uint64_t>(key.dataSetId) << 32) ^ key.tileId;
+    return std::hash<uint64_t>()(h);
+}
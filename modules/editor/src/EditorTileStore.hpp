@@ -0,0 +1,136 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+/** @file EditorTileStore.hpp */
+
+#ifndef EDITOR_TILE_STORE_HPP
+#define EDITOR_TILE_STORE_HPP
+
+#include <EditorTile.hpp>
+#include <memory>
+#include <unordered_map>
+
+/** Editor Tile Store.
+    Tiles shared by all viewports and the working cache. Resident tiles
+    are kept within a memory budget in bytes. Tiles in use are pinned,
+    unpinned tiles form least recently used lists which are evicted
+    from the tail when the budget is exceeded.
+
+    Admission is scan resistant (2Q): a tile which was used only once,
+    such as by a full data set pass of a plugin, is placed on probation
+    and evicted before tiles which were used repeatedly.
+
+    Prefetched tiles are not counted as used until a view pins them.
+    Unloaded tiles are dropped as soon as they are unpinned.
+*/
+class EditorTileStore
+{
+public:
+    /** Editor Tile Store Key. */
+    struct Key
+    {
+        size_t dataSetId;
+        size_t tileId;
+
+        bool operator==(const Key &rhs) const;
+    };
+
+    /** Editor Tile Store Key Hash. */
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const;
+    };
+
+    /** Editor Tile Store Statistics. */
+    struct Statistics
+    {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        size_t residentTiles;
+        size_t residentBytes;
+        size_t pinnedTiles;
+        size_t probationTiles;
+        size_t budget;
+
+        // Prefetch accuracy
+        uint64_t prefetchTiles;
+        uint64_t prefetchHits;
+        uint64_t prefetchCancelled;
+        uint64_t prefetchWastedTiles;
+        uint64_t prefetchWastedBytes;
+
+        Statistics();
+    };
+
+    EditorTileStore();
+    ~EditorTileStore();
+
+    EditorTileStore(const EditorTileStore &) = delete;
+    EditorTileStore &operator=(const EditorTileStore &) = delete;
+
+    void clear();
+    void reload(uint32_t filters);
+
+    void setBudget(size_t bytes);
+    size_t budget() const { return stats_.budget; }
+
+    std::shared_ptr<EditorTile> pin(const Key &key);
+    std::shared_ptr<EditorTile> prefetch(const Key &key);
+    void pin(const EditorTile &tile);
+    void unpin(const EditorTile &tile);
+    void update(const EditorTile &tile);
+
+    size_t size() const { return entries_.size(); }
+    size_t memorySize() const { return stats_.residentBytes; }
+    size_t memorySize(EditorTile::Column column) const;
+    const Statistics &statistics() const { return stats_; }
+
+protected:
+    /** Editor Tile Store Entry, intrusive LRU list node. */
+    struct Entry
+    {
+        std::shared_ptr<EditorTile> tile;
+        size_t bytes;
+        size_t pinCount;
+        size_t useCount;
+        bool prefetched;
+        Entry *prev;
+        Entry *next;
+    };
+
+    // Node based map, entry addresses are stable
+    std::unordered_map<Key, Entry, KeyHash> entries_;
+
+    // Sentinels, next is the most recently used unpinned tile
+    Entry lru_;
+    Entry probation_;
+
+    Statistics stats_;
+
+    void reset();
+    Entry &create(const Key &key);
+    void erase(Entry *entry);
+    void link(Entry *list, Entry *entry);
+    void unlink(Entry *entry);
+    void evict();
+};
+
+#endif /* EDITOR_TILE_STORE_HPP */
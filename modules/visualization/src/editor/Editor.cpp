@@ -20,17 +20,25 @@
 /** @file Editor.cpp */
 
 #include <Editor.hpp>
+#include <thread>
 
 Editor::Editor(QObject *parent) : QObject(parent), thread_(this)
 {
     connect(&thread_, SIGNAL(statusChanged()), this, SLOT(render()));
 
     thread_.init();
+
+    // Tiles handed over by the loader are shown without polling
+    setLoaderCallback([this]() { thread_.schedule(); });
+
+    size_t n = std::thread::hardware_concurrency();
+    setNumberOfLoaderThreads(n > 0 ? n : 1);
 }
 
 Editor::~Editor()
 {
     thread_.stop();
+    setNumberOfLoaderThreads(0);
 }
 
 // void Editor::renderRequest()
@@ -40,6 +48,9 @@ Editor::~Editor()
 
 void Editor::attach()
 {
+    // Plugins share the tile store with the viewports, they run with the
+    // render task suspended and lock the editor for each tile. Only
+    // painting of published tile snapshots is free of the editor lock.
     cancelThreads();
     // lock();
 }
@@ -62,7 +73,10 @@ void Editor::unlock()
 
 void Editor::cancelThreads()
 {
+    // The render task is suspended until restartThreads(), so the loader
+    // stays idle while the caller changes the editor
     thread_.cancel();
+    cancelLoader();
 }
 
 void Editor::restartThreads()
@@ -77,5 +91,11 @@ void Editor::render(size_t viewportId, const Camera &camera)
 
 void Editor::render()
 {
+    thread_.statusReceived();
     emit renderRequested();
 }
+
+void Editor::renderFinished()
+{
+    thread_.schedule();
+}
@@ -24,6 +24,7 @@
 
 #include <Camera.hpp>
 #include <EditorBase.hpp>
+#include <EditorScheduler.hpp>
 #include <QObject>
 #include <ThreadRender.hpp>
 #include <mutex>
@@ -45,6 +46,9 @@ public:
 
     void cancelThreads();
     void restartThreads();
+    void renderFinished();
+
+    EditorScheduler &scheduler() { return scheduler_; }
 
 signals:
     void renderRequested();
@@ -54,6 +58,7 @@ public slots:
     void render();
 
 protected:
+    EditorScheduler scheduler_;
     ThreadRender thread_;
     std::mutex mutex_;
 };
@@ -20,15 +20,15 @@
 /** @file ThreadRender.cpp */
 
 #include <Editor.hpp>
-#include <QDebug>
 #include <ThreadRender.hpp>
-#include <Time.hpp>
 
 ThreadRender::ThreadRender(Editor *editor, QObject *parent)
-    : Thread(parent),
+    : QObject(parent),
       editor_(editor),
-      viewportId_(0),
-      initialized_(false)
+      active_(false),
+      pending_(false),
+      suspended_(false),
+      status_(false)
 {
 }
 
@@ -36,50 +36,122 @@ ThreadRender::~ThreadRender()
 {
 }
 
-void ThreadRender::start(size_t viewportId, const Camera &camera)
+void ThreadRender::init()
 {
-    cancel();
+    if (queue_.numberOfThreads() == 0)
+    {
+        queue_.setNumberOfThreads(1);
+    }
+}
 
-    viewportId_ = viewportId;
-    camera_ = camera;
-    initialized_ = false;
+void ThreadRender::start(size_t viewportId, const Camera &camera)
+{
+    // The latest camera wins, the next step of the task applies it
+    editor_->scheduler().request(viewportId, camera);
 
-    Thread::start();
+    schedule();
 }
 
 void ThreadRender::restart()
 {
-    /** @todo Something is missing? */
-    cancel();
-    initialized_ = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        suspended_ = false;
+    }
+
+    editor_->scheduler().repeat();
+
+    schedule();
+}
+
+void ThreadRender::schedule()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
 
-    Thread::start();
+    // A running task makes one more pass over the view
+    pending_ = true;
+    if (!active_ && !suspended_)
+    {
+        push();
+    }
 }
 
-bool ThreadRender::compute()
+void ThreadRender::cancel()
 {
-    if (!initialized_)
+    // Loader notifications, painting and cameras do not start the task
+    // again while the editor is changed
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        suspended_ = true;
+    }
+
+    queue_.cancel();
+}
+
+void ThreadRender::stop()
+{
+    queue_.setNumberOfThreads(0);
+}
+
+void ThreadRender::statusReceived()
+{
+    status_ = false;
+}
+
+void ThreadRender::push()
+{
+    active_ = true;
+    queue_.push([this](const EditorTaskQueue::Token &) { return step(); },
+                EditorTaskQueue::PRIORITY_NORMAL,
+                [this](bool canceled) { finished(canceled); });
+}
+
+bool ThreadRender::step()
+{
+    EditorScheduler &scheduler = editor_->scheduler();
+
+    // Cameras received since the last step, the interactive one is last
+    if (scheduler.take(requests_))
     {
         editor_->lock();
-        editor_->updateCamera(viewportId_, camera_);
+        for (const auto &it : requests_)
+        {
+            editor_->updateCamera(it.viewportId, it.camera);
+        }
         editor_->unlock();
-        initialized_ = true;
         return false;
     }
 
-    double t1 = getRealTime();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_ = false;
+    }
+
     bool ret;
     editor_->lock();
     ret = editor_->loadView();
     editor_->unlock();
 
-    emit statusChanged();
-
-    double t2 = getRealTime();
-    if (t2 - t1 < 0.02)
+    if (ret)
     {
-        msleep(1);
+        scheduler.fullDetail();
     }
+    else if (!status_.exchange(true))
+    {
+        // Viewports draw what is ready and continue on their own
+        emit statusChanged();
+    }
+
+    return true;
+}
+
+void ThreadRender::finished(bool canceled)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
 
-    return ret;
+    active_ = false;
+    if (pending_ && !canceled && !suspended_)
+    {
+        push();
+    }
 }
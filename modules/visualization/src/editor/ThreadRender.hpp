@@ -23,13 +23,24 @@
 #define THREAD_RENDER_HPP
 
 #include <Camera.hpp>
+#include <EditorScheduler.hpp>
+#include <EditorTaskQueue.hpp>
 #include <QObject>
-#include <Thread.hpp>
+#include <atomic>
+#include <mutex>
 
 class Editor;
 
-/** Thread Render. */
-class ThreadRender : public Thread
+/** Thread Render.
+    Render task of the editor, it runs only when there is something to do:
+    a new camera, a tile handed over by the loader or a viewport which has
+    drawn its whole view. Tiles are prepared by the loader threads of the
+    editor. Camera updates are coalesced by the editor scheduler, the
+    caller does not wait for the thread. Status is emitted again only
+    after the previous one was received. After cancel() the task is not
+    scheduled again until restart(), requests are kept for that time.
+*/
+class ThreadRender : public QObject
 {
     Q_OBJECT
 
@@ -37,19 +48,33 @@ public:
     ThreadRender(Editor *editor, QObject *parent = nullptr);
     virtual ~ThreadRender();
 
+    void init();
     void start(size_t viewportId, const Camera &camera);
     void restart();
+    void schedule();
+    void cancel();
+    void stop();
 
-    virtual bool compute();
+    void statusReceived();
 
 signals:
     void statusChanged();
 
 protected:
     Editor *editor_;
-    size_t viewportId_;
-    Camera camera_;
-    bool initialized_;
+    std::vector<EditorScheduler::Request> requests_;
+
+    std::mutex mutex_;
+    bool active_;
+    bool pending_;
+    bool suspended_;
+    std::atomic<bool> status_;
+
+    EditorTaskQueue queue_;
+
+    void push();
+    bool step();
+    void finished(bool canceled);
 };
 
 #endif /* THREAD_RENDER_HPP */
@@ -190,6 +190,9 @@ Camera GLCamera::toCamera() const
     ret.center.set(center_.x(), center_.y(), center_.z());
     ret.up.set(up_.x(), up_.y(), up_.z());
     ret.fov = fov_;
+    ret.width = static_cast<size_t>(viewport_.width());
+    ret.height = static_cast<size_t>(viewport_.height());
+    ret.perspective = perspective_;
 
     return ret;
 }
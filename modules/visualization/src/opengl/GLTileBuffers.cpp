@@ -0,0 +1,199 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file GLTileBuffers.cpp */
+
+#include <GLTileBuffers.hpp>
+#include <QOpenGLFunctions>
+#include <algorithm>
+
+GLTileBuffers::Buffers::Buffers()
+    : xyz(QOpenGLBuffer::VertexBuffer),
+      rgba(QOpenGLBuffer::VertexBuffer),
+      indices(QOpenGLBuffer::IndexBuffer),
+      xyzSize(0),
+      rgbaSize(0),
+      indicesSize(0)
+{
+}
+
+GLTileBuffers::GLTileBuffers() : bytes_(0)
+{
+}
+
+GLTileBuffers::~GLTileBuffers()
+{
+}
+
+void GLTileBuffers::render(const std::shared_ptr<EditorTile> &tile,
+                           const std::shared_ptr<const EditorTile::View> &view,
+                           size_t begin,
+                           size_t end)
+{
+    // A destroyed tile can be followed by a new one at the same address
+    Buffers &buffers = buffers_[tile.get()];
+    if (buffers.tile.lock() != tile)
+    {
+        destroy(buffers);
+        buffers.tile = tile;
+        create(buffers, *tile);
+    }
+
+    // Published views are immutable, a new view means new colors
+    if (buffers.view.lock() != view)
+    {
+        buffers.view = view;
+        update(buffers, *view);
+    }
+
+    // Range of visible points in their progressive order
+    end = std::min(end, view->indices.size());
+    if (begin >= end || !buffers.xyz.isCreated())
+    {
+        return;
+    }
+
+    // Quantized positions are scaled by the model transform of the tile
+    glEnableClientState(GL_VERTEX_ARRAY);
+    buffers.xyz.bind();
+    glVertexPointer(3, GL_SHORT, 0, nullptr);
+
+    if (buffers.rgba.isCreated())
+    {
+        glEnableClientState(GL_COLOR_ARRAY);
+        buffers.rgba.bind();
+        glColorPointer(4, GL_UNSIGNED_BYTE, 0, nullptr);
+    }
+    else
+    {
+        glColor3f(1.0F, 1.0F, 1.0F);
+    }
+
+    buffers.indices.bind();
+    glDrawElements(GL_POINTS,
+                   static_cast<GLsizei>(end - begin),
+                   GL_UNSIGNED_INT,
+                   reinterpret_cast<const void *>(begin * sizeof(GLuint)));
+
+    buffers.indices.release();
+    QOpenGLBuffer::release(QOpenGLBuffer::VertexBuffer);
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_COLOR_ARRAY);
+}
+
+void GLTileBuffers::release()
+{
+    // Tiles are destroyed when they are evicted from the editor cache
+    auto it = buffers_.begin();
+    while (it != buffers_.end())
+    {
+        if (it->second.tile.expired())
+        {
+            destroy(it->second);
+            it = buffers_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void GLTileBuffers::clear()
+{
+    for (auto &it : buffers_)
+    {
+        destroy(it.second);
+    }
+    buffers_.clear();
+}
+
+void GLTileBuffers::create(Buffers &buffers, const EditorTile &tile)
+{
+    if (tile.renderXyz.empty())
+    {
+        return;
+    }
+
+    int n = static_cast<int>(tile.renderXyz.size() * sizeof(int16_t));
+    buffers.xyz.create();
+    buffers.xyz.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    buffers.xyz.bind();
+    buffers.xyz.allocate(tile.renderXyz.data(), n);
+    buffers.xyz.release();
+
+    buffers.xyzSize = n;
+    bytes_ += static_cast<size_t>(n);
+}
+
+void GLTileBuffers::update(Buffers &buffers, const EditorTile::View &view)
+{
+    bytes_ -= static_cast<size_t>(buffers.rgbaSize + buffers.indicesSize);
+
+    // Colors keep their size, the buffer is rewritten in place
+    if (!view.rgba.empty())
+    {
+        int n = static_cast<int>(view.rgba.size());
+        if (!buffers.rgba.isCreated())
+        {
+            buffers.rgba.create();
+            buffers.rgba.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+        }
+        buffers.rgba.bind();
+        if (buffers.rgbaSize == n)
+        {
+            buffers.rgba.write(0, view.rgba.data(), n);
+        }
+        else
+        {
+            buffers.rgba.allocate(view.rgba.data(), n);
+            buffers.rgbaSize = n;
+        }
+        buffers.rgba.release();
+    }
+
+    // Number of visible points depends on filters
+    int n = static_cast<int>(view.indices.size() * sizeof(unsigned int));
+    if (!buffers.indices.isCreated())
+    {
+        buffers.indices.create();
+        buffers.indices.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    }
+    buffers.indices.bind();
+    buffers.indices.allocate(view.indices.data(), n);
+    buffers.indices.release();
+    buffers.indicesSize = n;
+
+    bytes_ += static_cast<size_t>(buffers.rgbaSize + buffers.indicesSize);
+}
+
+void GLTileBuffers::destroy(Buffers &buffers)
+{
+    bytes_ -= static_cast<size_t>(buffers.xyzSize + buffers.rgbaSize +
+                                  buffers.indicesSize);
+
+    buffers.xyz.destroy();
+    buffers.rgba.destroy();
+    buffers.indices.destroy();
+    buffers.view.reset();
+    buffers.xyzSize = 0;
+    buffers.rgbaSize = 0;
+    buffers.indicesSize = 0;
+}
@@ -0,0 +1,77 @@
+/*
+    Copyright 2020 VUKOZ
+
+    This file is part of 3D Forest.
+
+    3D Forest is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    3D Forest is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with 3D Forest.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/** @file GLTileBuffers.hpp */
+
+#ifndef GL_TILE_BUFFERS_HPP
+#define GL_TILE_BUFFERS_HPP
+
+#include <EditorTile.hpp>
+#include <QOpenGLBuffer>
+#include <memory>
+#include <unordered_map>
+
+/** OpenGL Tile Buffers.
+    Quantized points of tiles are uploaded to vertex buffers once, when
+    the tile is drawn for the first time, and drawn from GPU memory. Colors
+    and point indices are uploaded again only when the tile publishes a new
+    view, after filters changed. Buffers of tiles which were evicted from
+    the editor cache are released. Called with the OpenGL context current.
+*/
+class GLTileBuffers
+{
+public:
+    GLTileBuffers();
+    ~GLTileBuffers();
+
+    void render(const std::shared_ptr<EditorTile> &tile,
+                const std::shared_ptr<const EditorTile::View> &view,
+                size_t begin,
+                size_t end);
+    void release();
+    void clear();
+
+    size_t size() const { return buffers_.size(); }
+    size_t memorySize() const { return bytes_; }
+
+protected:
+    /** OpenGL Tile Buffers Entry. */
+    struct Buffers
+    {
+        std::weak_ptr<EditorTile> tile;
+        std::weak_ptr<const EditorTile::View> view;
+        QOpenGLBuffer xyz;
+        QOpenGLBuffer rgba;
+        QOpenGLBuffer indices;
+        int xyzSize;
+        int rgbaSize;
+        int indicesSize;
+
+        Buffers();
+    };
+
+    std::unordered_map<const EditorTile *, Buffers> buffers_;
+    size_t bytes_;
+
+    void create(Buffers &buffers, const EditorTile &tile);
+    void update(Buffers &buffers, const EditorTile::View &view);
+    void destroy(Buffers &buffers);
+};
+
+#endif /* GL_TILE_BUFFERS_HPP */
@@ -28,6 +28,10 @@
 #include <Time.hpp>
 #include <WindowViewports.hpp>
 
+// Time budget of one frame in seconds, the rest of the view is refined
+// in the next frames
+#define GL_WIDGET_FRAME_BUDGET 0.016
+
 GLWidget::GLWidget(QWidget *parent)
     : QOpenGLWidget(parent),
       windowViewports_(nullptr),
@@ -41,6 +45,10 @@ GLWidget::GLWidget(QWidget *parent)
 
 GLWidget::~GLWidget()
 {
+    // Vertex buffers are released in the context of this widget
+    makeCurrent();
+    buffers_.clear();
+    doneCurrent();
 }
 
 void GLWidget::setWindowViewports(WindowViewports *viewer, size_t viewportId)
@@ -260,13 +268,18 @@ bool GLWidget::renderScene()
 
     bool firstFrame = false;
 
-    editor_->lock();
+    // Tiles are drawn from published snapshots without the editor lock,
+    // editor settings are modified only by this thread
+    std::shared_ptr<EditorCache::Snapshot> view =
+        editor_->tileViewSnapshot(viewportId_);
 
     renderSceneSettingsEnable();
 
+    buffers_.release();
+
     double t1 = getRealTime();
 
-    size_t tileViewSize = editor_->tileViewSize(viewportId_);
+    size_t tileViewSize = view->tiles.size();
 
     if (tileViewSize == 0)
     {
@@ -276,23 +289,47 @@ bool GLWidget::renderScene()
 
     for (size_t tileIndex = 0; tileIndex < tileViewSize; tileIndex++)
     {
-        EditorTile &tile = editor_->tileView(viewportId_, tileIndex);
+        const EditorTile &tile = *view->tiles[tileIndex];
+        EditorCache::Frame &frame = view->frames[tileIndex];
+        std::shared_ptr<const EditorTile::View> tileView = tile.snapshot();
+
+        if (tileView)
+        {
+            frame.setPointCount(tileView->indices.size());
+        }
 
-        if (tile.renderMore())
+        if (tileView && !frame.isFinished())
         {
-            if (tileIndex == 0 && tile.view.isStarted())
+            if (tileIndex == 0 && frame.isStarted())
             {
                 clearScreen();
                 firstFrame = true;
             }
 
-            GL::render(GL::POINTS, tile.view.xyz, tile.view.rgb, tile.indices);
-            glFlush();
+            // Model transform of the data set, quantized points are
+            // relative to tile origin
+            size_t begin;
+            size_t end;
+            frame.renderRange(begin, end);
+            if (begin < end)
+            {
+                const EditorDataSet &dataSet =
+                    editor_->dataSet(tile.dataSetId);
+                Vector3<double> t =
+                    dataSet.translation + tile.origin + tile.renderOrigin;
+                const Vector3<double> &s = tile.renderScale;
+                glPushMatrix();
+                glTranslated(t[0], t[1], t[2]);
+                glScaled(s[0], s[1], s[2]);
+                buffers_.render(view->tiles[tileIndex], tileView, begin, end);
+                glPopMatrix();
+                glFlush();
+            }
 
-            tile.view.nextFrame();
+            frame.nextFrame();
 
             double t2 = getRealTime();
-            if (t2 - t1 > 0.02)
+            if (t2 - t1 > GL_WIDGET_FRAME_BUDGET)
             {
                 break;
             }
@@ -301,13 +338,37 @@ bool GLWidget::renderScene()
 
     renderSceneSettingsDisable();
 
+    // Tiles which are ready are drawn in the next frames without waiting
+    // for the render thread, it is notified when the whole view is drawn
+    bool finished = true;
+    bool pending = false;
+    for (size_t tileIndex = 0; tileIndex < tileViewSize; tileIndex++)
+    {
+        if (!view->frames[tileIndex].isFinished())
+        {
+            finished = false;
+            if (view->tiles[tileIndex]->snapshot())
+            {
+                pending = true;
+            }
+        }
+    }
+
+    if (pending)
+    {
+        update();
+    }
+    else if (finished)
+    {
+        editor_->renderFinished();
+    }
+
     if (firstFrame)
     {
         GL::renderClipFilter(editor_->clipFilter());
+        editor_->scheduler().firstPixel(viewportId_);
     }
 
-    editor_->unlock();
-
     return firstFrame;
 }
 
@@ -25,6 +25,7 @@
 #include <Camera.hpp>
 #include <GLAabb.hpp>
 #include <GLCamera.hpp>
+#include <GLTileBuffers.hpp>
 #include <QOpenGLFunctions>
 #include <QOpenGLWidget>
 
@@ -81,6 +82,7 @@ protected:
     Editor *editor_;
     GLAabb aabb_;
     GLCamera camera_;
+    GLTileBuffers buffers_;
 
     void resetCamera();
     void clearScreen();